@@ -15,6 +15,7 @@
 #include <vulkan/vulkan.h>
 
 #include <cstddef>
+#include <atomic>
 #include <cstdint>
 #include <mutex>
 #include <unordered_map>
@@ -69,6 +70,7 @@ public:
     void flush_to_device();       // host staging -> device (before kernels read)
     void invalidate_from_device(); // device -> host staging (after kernels write)
     bool uma() const { return uma_; }
+    uint64_t migrations() const { return migrations_.load(); }  // copies submitted so far
 
     // Accessors.
     void*                     host_base() const { return host_base_; }
@@ -105,6 +107,8 @@ private:
     VkCommandPool   xfer_pool_ = VK_NULL_HANDLE;
     VkCommandBuffer xfer_cmd_ = VK_NULL_HANDLE;
     VkFence         xfer_fence_ = VK_NULL_HANDLE;
+    std::mutex      xfer_mutex_;                      // guards xfer_cmd_/xfer_fence_
+    std::atomic<uint64_t> migrations_{0};
     VkDeviceSize    capacity_ = 0;
     VkDeviceSize    bump_ = 0;        // next never-used offset
     VkDeviceSize    high_water_ = 0;  // bytes ever handed out (bump_ minus reuse)
@@ -0,0 +1,215 @@
+#ifndef PARALLAX_ASYNC_HPP
+#define PARALLAX_ASYNC_HPP
+
+// C++20 coroutine awaitables for the offloaded algorithms:
+//
+//     float sum = co_await parallax::async::reduce(parallax::par, v.begin(), v.end(), 0.f);
+//
+// Each factory returns a task that, when awaited, hands the algorithm to one runtime
+// completion thread and suspends the coroutine. That thread issues the algorithm
+// through the same stdpar funnels as the blocking form, on a stream of its own (stream
+// serials and launch epilogues are per host thread, so the thread that issues the work
+// is also the one that polls and retires it). It polls the stream's event between
+// short sleeps, runs the host work that follows the launches (copying staged output
+// back, freeing arena scratch), and hands the coroutine on to be resumed: by a small
+// runtime pool of resumption threads by default, through the executor given to via()
+// (e.g. one that posts the handle to the caller's event loop), or, with
+// inline_resume(), on the completion thread itself. Inline resumption saves a thread
+// switch, but until the resumed code suspends again no other awaited algorithm retires.
+//
+// Policies that do not offload run the host algorithm on the awaiting thread when the
+// task is awaited, without suspending. A funnel that misses its kernel falls back to
+// the host algorithm where it was issued, on the completion thread.
+// The ranges must stay alive and untouched until the awaiting coroutine resumes.
+
+#include <parallax/stdpar.hpp>
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace parallax::async {
+
+// Resumes an awaiting coroutine once its algorithm completed. Empty: resume on the
+// runtime's resumption pool (or inline, see task::inline_resume).
+using executor = std::function<void(std::coroutine_handle<>)>;
+
+namespace detail {
+
+// One awaited algorithm, as the completion thread sees it.
+struct operation {
+    std::function<void(parallax::detail::async_issue&)> issue;  // issues the work
+    std::function<void()> complete;  // after the work and its finishers: store the value
+    executor resume_on;
+    bool resume_inline = false;  // without resume_on: on the completion thread
+    std::coroutine_handle<> handle;
+    std::exception_ptr error;  // thrown by issue or complete; rethrown on resumption
+};
+
+// Hands `op` to the completion thread, which issues it, retires it once its stream's
+// work completed and resumes op->handle. `op` must stay alive until then.
+void submit(operation* op);
+
+}  // namespace detail
+
+// Awaitable result of one algorithm. Await it once; it must not move while awaited.
+template <class T>
+class [[nodiscard]] task {
+public:
+    // `issue` launches the work (with parallax::detail::current_async set, so the
+    // funnels go to the stream); `finish` yields the value once it has completed.
+    task(std::function<void(parallax::detail::async_issue&)> issue, std::function<T()> finish)
+        : finish_(std::move(finish)) {
+        op_.issue = [issue = std::move(issue)](parallax::detail::async_issue& a) {
+            struct scope {
+                explicit scope(parallax::detail::async_issue* a) { parallax::detail::current_async = a; }
+                ~scope() { parallax::detail::current_async = nullptr; }
+            } current(&a);
+            issue(a);
+        };
+    }
+
+    // Host-only work (a policy that does not offload): `run` yields the value on the
+    // awaiting thread when the task is awaited, which then does not suspend.
+    static task host(std::function<T()> run) {
+        task t({}, std::move(run));
+        t.host_ = true;
+        return t;
+    }
+
+    // Resume the awaiting coroutine through `ex` instead of on the resumption pool.
+    task via(executor ex) && {
+        op_.resume_on = std::move(ex);
+        return std::move(*this);
+    }
+
+    // Resume the awaiting coroutine on the completion thread itself. Only for short
+    // code: every other awaited algorithm waits until it suspends again or returns.
+    task inline_resume() && {
+        op_.resume_inline = true;
+        return std::move(*this);
+    }
+
+    bool await_ready() {
+        if (!host_) return false;
+        if constexpr (std::is_void_v<T>) finish_();
+        else value_.emplace(finish_());
+        return true;
+    }
+    void await_suspend(std::coroutine_handle<> handle) {
+        op_.handle = handle;
+        op_.complete = [this] {
+            if constexpr (std::is_void_v<T>) finish_();
+            else value_.emplace(finish_());
+        };
+        detail::submit(&op_);
+    }
+    T await_resume() {
+        if (op_.error) std::rethrow_exception(op_.error);
+        if constexpr (!std::is_void_v<T>) return std::move(*value_);
+    }
+
+private:
+    struct none {};
+    detail::operation op_;
+    std::function<T()> finish_;
+    bool host_ = false;
+    std::optional<std::conditional_t<std::is_void_v<T>, none, T>> value_;
+};
+
+// Explicit kernels: `issue(stream)` launches work with the parallax_*_async C API on the
+// given stream; the coroutine resumes once all of it has completed.
+template <class F>
+task<void> run(F issue) {
+    return task<void>([issue = std::move(issue)](parallax::detail::async_issue& a) { issue(a.stream); },
+                      [] {});
+}
+
+// ---- Algorithm surface (mirrors stdpar.hpp) --------------------------------
+
+template <class Policy, class It, class F>
+task<void> for_each(Policy&&, It first, It last, F f) {
+    if constexpr (parallax::detail::offload_ok_v<Policy, It>) {
+        return task<void>([first, last, f](parallax::detail::async_issue&) {
+            auto n = static_cast<std::size_t>(std::distance(first, last));
+            if (n) parallax::detail::device_invoke(&*first, n, f);
+        }, [] {});
+    } else {
+        return task<void>::host([first, last, f] { std::for_each(first, last, f); });
+    }
+}
+
+template <class Policy, class InIt, class OutIt, class F>
+task<OutIt> transform(Policy&&, InIt first, InIt last, OutIt d_first, F f) {
+    if constexpr (parallax::detail::offload_ok_v<Policy, InIt, OutIt>) {
+        using D = typename std::iterator_traits<OutIt>::difference_type;
+        auto n = static_cast<std::size_t>(std::distance(first, last));
+        return task<OutIt>([first, d_first, n, f](parallax::detail::async_issue&) {
+            if (n) parallax::detail::device_transform(&*first, &*d_first, n, f);
+        }, [d_first, n] { return std::next(d_first, static_cast<D>(n)); });
+    } else {
+        return task<OutIt>::host([first, last, d_first, f] {
+            return std::transform(first, last, d_first, f);
+        });
+    }
+}
+
+template <class Policy, class It, class T>
+task<T> reduce(Policy&&, It first, It last, T init) {
+    if constexpr (parallax::detail::offload_ok_v<Policy, It>) {
+        // As parallax::reduce: the device reduces in the element type, init is added on
+        // the host.
+        using E = typename std::iterator_traits<It>::value_type;
+        auto sum = std::make_shared<E>();
+        return task<T>([first, last, sum](parallax::detail::async_issue& a) {
+            auto n = static_cast<std::size_t>(std::distance(first, last));
+            if (n == 0) return;
+            a.result = sum.get();
+            E gpu = parallax::detail::device_reduce<E>(&*first, n, E{});
+            if (!a.pending) *sum = gpu;
+        }, [init, sum] { return init + static_cast<T>(*sum); });
+    } else {
+        return task<T>::host([first, last, init] { return std::reduce(first, last, init); });
+    }
+}
+
+template <class Policy, class It>
+task<void> sort(Policy&&, It first, It last) {
+    if constexpr (parallax::detail::offload_ok_v<Policy, It>) {
+        return task<void>([first, last](parallax::detail::async_issue&) {
+            auto n = static_cast<std::size_t>(std::distance(first, last));
+            if (n) parallax::detail::device_sort(&*first, n);
+        }, [] {});
+    } else {
+        return task<void>::host([first, last] { std::sort(first, last); });
+    }
+}
+
+template <class Policy, class It, class OutIt, class Pred>
+task<OutIt> copy_if(Policy&&, It first, It last, OutIt d_first, Pred pred) {
+    if constexpr (parallax::detail::offload_ok_v<Policy, It, OutIt>) {
+        using D = typename std::iterator_traits<OutIt>::difference_type;
+        using E = typename std::iterator_traits<It>::value_type;
+        auto kept = std::make_shared<std::size_t>(0);
+        return task<OutIt>([first, last, d_first, pred, kept](parallax::detail::async_issue& a) {
+            auto n = static_cast<std::size_t>(std::distance(first, last));
+            if (n == 0) return;
+            a.result = kept.get();
+            std::size_t k = parallax::detail::device_copy_if<E, Pred>(&*first, &*d_first, n, pred);
+            if (!a.pending) *kept = k;
+        }, [d_first, kept] { return std::next(d_first, static_cast<D>(*kept)); });
+    } else {
+        return task<OutIt>::host([first, last, d_first, pred] {
+            return std::copy_if(first, last, d_first, pred);
+        });
+    }
+}
+
+}  // namespace parallax::async
+
+#endif  // PARALLAX_ASYNC_HPP
@@ -3,49 +3,129 @@
 
 #include "parallax/vulkan_backend.hpp"
 #include "parallax/unified_buffer.hpp"
+#include "parallax/workgroup_tuner.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 #include <unordered_map>
 
 namespace parallax {
 
+// A loaded kernel: pipeline, layouts and the binding metadata a dispatch needs.
+// Immutable once load_kernel() returns it; launches take the handle directly, so no
+// launch looks a kernel up by name. The Vulkan objects are owned by the launcher and
+// destroyed with it (no launch can run after that); the refcount only keeps the
+// struct itself alive for as long as any handle refers to it.
 struct PipelineData {
     VkPipeline pipeline = VK_NULL_HANDLE;
     VkPipelineLayout layout = VK_NULL_HANDLE;
     VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
     VkShaderModule shader_module = VK_NULL_HANDLE;
+    // Descriptor type of each binding of the shared layout (storage@0/1/3, uniform@2),
+    // and whether the set layout was created for push descriptors.
+    VkDescriptorType binding_types[4] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                         VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+    bool push_descriptor = false;
+    std::string name;  // diagnostics only
+
+    // Workgroup size. `pipeline` is built at the shader's own size (its local_size_x,
+    // or the default of its workgroup-size specialization constant). A shader that
+    // sizes its workgroup through a specialization constant (local_size_x_id) also
+    // gets one pipeline per candidate size the device allows, ascending by size; the
+    // tuner picks among them per problem size. Fixed-size shaders have no variants.
+    uint32_t workgroup_size = 256;
+    struct Variant {
+        uint32_t size;
+        VkPipeline pipeline;
+    };
+    std::vector<Variant> variants;
+    uint64_t spirv_hash = 0;  // names the kernel in the tuning cache across runs
+    // The shader linearizes its workgroup id (y * gl_NumWorkGroups.x + x), so it may
+    // be dispatched as a 2D grid past maxComputeWorkGroupCount[0] workgroups.
+    bool grid_2d = false;
+    // Storage bindings the shader declares readonly (bit b: binding b). Hazard tracking
+    // counts every other bound storage range as written.
+    uint32_t readonly_bindings = 0;
+    // Descriptor-free ABI: the shader uses physical storage buffer addressing and
+    // declares no descriptors, so its layout has no set at all. Its push block is the
+    // 32-byte PushBlock header followed by one 64-bit address per array, in order
+    // (storage bindings 0, 1, 3 on the ordinary launch paths); each address points
+    // at the first element of the chunk being dispatched, `base` gives its global
+    // index. `address_args` is how many addresses fit in this device's push block.
+    bool address_abi = false;
+    uint32_t address_args = 0;
+    // Bytes of the pipeline layout's push-constant range (every push fits in it).
+    uint32_t push_size = 32;
+    // Loaded with KernelLauncher::kInlineCaptures: the kernel reads its captures from
+    // the push block, right after the header (after the addresses for an address-ABI
+    // kernel), instead of the uniform@2 block, and leaves binding 2 undeclared. The
+    // captures of a launch must fit in the `inline_captures` bytes the device leaves.
+    uint32_t inline_captures = 0;
+
+    VkPipeline pipeline_for(uint32_t size) const {
+        for (const Variant& v : variants)
+            if (v.size == size) return v.pipeline;
+        return pipeline;
+    }
 };
+using PipelineHandle = std::shared_ptr<const PipelineData>;
 
+// Thread safety: every public member may be called concurrently from any number of
+// host threads. Loaded pipelines are immutable and shared through their handles;
+// everything a launch records into -- command pool and frame ring, descriptor pool
+// and descriptor-set cache, async state -- lives in a per-thread launch context that
+// is created on the thread's first launch. Only vkQueueSubmit is serialized, through
+// the backend's queue lock, so independent threads record and wait in parallel.
 class KernelLauncher {
 public:
+    // Bytes of PushBlock at the front of every push block; an address-ABI kernel's
+    // array addresses follow it. 28 addresses fill the 256 bytes most devices allow;
+    // the 128 bytes Vulkan guarantees hold 12.
+    static constexpr uint32_t kPushHeaderSize = 32;
+    static constexpr uint32_t kMaxAddressArgs = 28;
+    static constexpr uint32_t kMaxPushSize = kPushHeaderSize + kMaxAddressArgs * 8;
+
+    // load_kernel() flags (the C API's PARALLAX_KERNEL_* metadata flags).
+    // kInlineCaptures: the kernel reads captures from the push block after the header
+    // (see PipelineData::inline_captures).
+    static constexpr uint32_t kInlineCaptures = 0x1;
+
     KernelLauncher(VulkanBackend* backend, MemoryManager* memory_manager);
     ~KernelLauncher();
     
-    // Load SPIR-V kernel with name
-    bool load_kernel(const std::string& name, const uint32_t* spirv_code, size_t spirv_size);
+    // Load a SPIR-V kernel. Returns its handle, or nullptr on failure. `name` only
+    // labels diagnostics; `flags` are the k* load flags above.
+    PipelineHandle load_kernel(const std::string& name, const uint32_t* spirv_code, size_t spirv_size,
+                               uint32_t flags = 0);
     
-    // Launch kernel by name (vector_multiply specific)
-    bool launch(const std::string& kernel_name, void* buffer, size_t count, float multiplier,
+    // Launch a vector_multiply-style kernel (buffer, count, multiplier)
+    bool launch(const PipelineHandle& kernel, void* buffer, size_t count, float multiplier,
                 size_t elem_size = sizeof(float));
 
     // Generic launch (buffer + count). elem_size is the per-element byte size of
     // the data buffer (e.g. sizeof(float)=4, sizeof(int64_t)=8); defaults to float
     // for backward compatibility.
-    bool launch(const std::string& kernel_name, void* buffer, size_t count,
+    bool launch(const PipelineHandle& kernel, void* buffer, size_t count,
                 size_t elem_size = sizeof(float));
 
     // Transform launch (in/out buffers + count). out_elem_size may differ from the
     // input element size (e.g. a float -> double map); 0 means "same as in". When
     // `captures` is non-null, its `capture_size` bytes are bound as the uniform@2 block
     // (a capturing transform op); otherwise binding 2 is a zero dummy. The captures path
-    // bypasses the descriptor cache (captures vary per call).
-    bool launch_transform(const std::string& kernel_name, void* in_buffer, void* out_buffer,
+    // bypasses the descriptor cache (captures vary per call), unless the kernel takes
+    // its captures inline (PipelineData::inline_captures): they are then pushed with
+    // the header and nothing is bound at binding 2.
+    bool launch_transform(const PipelineHandle& kernel, void* in_buffer, void* out_buffer,
                           size_t count, size_t elem_size = sizeof(float), size_t out_elem_size = 0,
                           void* captures = nullptr, size_t capture_size = 0);
 
     // NEW V2: Launch with captured parameters (for function objects)
     bool launch_with_captures(
-        const std::string& kernel_name,
+        const PipelineHandle& kernel,
         void* buffer,
         size_t count,
         void* captures,
@@ -53,133 +133,680 @@ public:
         size_t elem_size = sizeof(float)
     );
 
+    // Batched launches (the C API's parallax_launch_batch): every launch is recorded
+    // into one submission, with a compute barrier before launch i only when its
+    // `depends` mask (bit k = launches[i-1-k]) names a launch recorded since the last
+    // barrier. Each launch is a launch_transform, or an in-place launch_with_captures
+    // when `out` is null. Every kernel and buffer is checked before recording starts,
+    // so a bad entry fails the batch without running any of it.
+    struct BatchLaunch {
+        PipelineHandle kernel;
+        void* in = nullptr;
+        void* out = nullptr;
+        size_t count = 0;
+        size_t in_elem_size = sizeof(float);
+        size_t out_elem_size = 0;  // 0: same as in
+        const void* captures = nullptr;
+        size_t capture_size = 0;
+        uint64_t depends = 0;
+    };
+    bool launch_batch(const BatchLaunch* launches, size_t n);
+
+    // Launch an address-ABI kernel (see PipelineData::address_abi) over `count`
+    // elements with `num_arrays` arena-resident arrays, passed as device addresses in
+    // the push block instead of descriptors: no set is allocated or bound, and the
+    // array count is not limited by the shared 3-binding layout. elem_sizes[i] is the
+    // element size of arrays[i], used to address each chunk of a launch past the
+    // dispatch limit; 0 passes that array unchanged (e.g. a lookup table).
+    bool launch_addressed(const PipelineHandle& kernel, size_t count, void* const* arrays,
+                          const size_t* elem_sizes, size_t num_arrays);
+
     // Parallel reduction (Phase 3). Reduces `count` elements of the data buffer to
     // a single scalar by dispatching the workgroup-reduction kernel iteratively
     // (data -> partials -> ... -> one element), ping-ponging through arena scratch.
+    // All levels are recorded into one command buffer with barriers between them,
+    // so the whole reduction is one submit and one fence wait.
     // The single reduced value (elem_size bytes) is written to out_result. The
     // kernel applies the '+' identity, so the caller combines any init separately.
-    bool launch_reduce(const std::string& kernel_name, void* data, size_t count,
+    bool launch_reduce(const PipelineHandle& kernel, void* data, size_t count,
                        size_t elem_size, void* out_result);
 
     // Phase 8: arg-min / arg-max (min/max/minmax_element, find family). Dispatches the
     // block-level argmax kernel (data@0, per-block winner value@1, index@3) then combines
     // the few per-block winners on the host (ties -> smaller index). is_float + elem_size
     // select the host value comparison. Returns the winning index, or count on empty.
-    size_t launch_argminmax(const std::string& kernel_name, void* data, size_t count,
+    size_t launch_argminmax(const PipelineHandle& kernel, void* data, size_t count,
                             size_t elem_size, bool is_float, bool want_max, bool want_last);
 
     // Phase 8: find_if / find_if_not. Dispatches the predicate-find kernel (data@0, per-block
     // min matching index@1) and returns the overall min -> the FIRST match, or `count` if none.
-    size_t launch_find(const std::string& kernel_name, void* data, size_t count,
+    size_t launch_find(const PipelineHandle& kernel, void* data, size_t count,
                        size_t elem_size, bool negate, const void* value = nullptr);
 
     // Phase 8: mismatch / equal. Dispatches the two-range mismatch kernel (a@0, b@3,
     // per-block min mismatch index@1) and returns the first mismatch index, or `count`
     // if the ranges are equal up to count.
-    size_t launch_mismatch(const std::string& kernel_name, void* a, void* b,
+    size_t launch_mismatch(const PipelineHandle& kernel, void* a, void* b,
                            size_t count, size_t elem_size);
 
     // Inclusive prefix scan (Phase 5). Scans `data` in place: per-block scan
-    // (scan_kernel) writing block totals, scan of those totals, then add the
-    // exclusive block offsets back (add_kernel). MVP: count <= 256*256 (the block
-    // sums fit one workgroup). Scratch is taken from the arena.
-    bool launch_scan(const std::string& scan_kernel, const std::string& add_kernel,
+    // (scan_kernel) writing block totals, scan of those totals (recursively, for
+    // any count), then add the exclusive block offsets back (add_kernel). Every
+    // level is planned up front from one arena allocation and recorded into one
+    // command buffer, so the whole scan is one submit and one wait.
+    bool launch_scan(const PipelineHandle& scan_kernel, const PipelineHandle& add_kernel,
                      void* data, size_t count, size_t elem_size);
 
     // Exclusive prefix scan (Phase 5), fully on-GPU. Runs the inclusive scan over
     // `input` (in place; caller passes a scratch copy) via scan_kernel+add_kernel, then
     // the shift_kernel writes `output[i] = init + (i>0 ? incl[i-1] : 0)`. `init` points
-    // at elem_size bytes (the caller's init value). Default '+'. Same count limit as scan.
-    bool launch_exclusive_scan(const std::string& scan_kernel, const std::string& add_kernel,
-                               const std::string& shift_kernel, void* input, void* output,
+    // at elem_size bytes (the caller's init value). Default '+'. The scan and the shift
+    // share one submission.
+    bool launch_exclusive_scan(const PipelineHandle& scan_kernel, const PipelineHandle& add_kernel,
+                               const PipelineHandle& shift_kernel, void* input, void* output,
                                size_t count, size_t elem_size, const void* init);
 
     // Bitonic sort (Phase 5). Sorts `data` in place ascending. The kernel is a
     // global compare-exchange stage dispatched O(log^2 n) times over the (k,j)
-    // schedule. MVP: count must be a power of two (the caller pads otherwise).
-    bool launch_sort(const std::string& kernel_name, void* data, size_t count,
+    // schedule, all recorded into one command buffer (one submit, one wait).
+    // MVP: count must be a power of two (the caller pads otherwise).
+    bool launch_sort(const PipelineHandle& kernel, void* data, size_t count,
                      size_t elem_size);
 
     // Stream compaction / copy_if (Phase 5). flags_kernel writes 1/0 per element
     // (predicate), scan_kernel+add_kernel turn that into output positions, and
     // scatter_kernel writes each kept element to output[pos-1]. Returns the number
-    // of kept elements via out_kept. input/output/scratch are arena-backed.
-    bool launch_compact(const std::string& flags_kernel, const std::string& scan_kernel,
-                        const std::string& add_kernel, const std::string& scatter_kernel,
+    // of kept elements via out_kept. input/output/scratch are arena-backed. The kept
+    // count stays on the device: only its elem_size bytes are copied back, and the
+    // whole pipeline is one submission.
+    bool launch_compact(const PipelineHandle& flags_kernel, const PipelineHandle& scan_kernel,
+                        const PipelineHandle& add_kernel, const PipelineHandle& scatter_kernel,
                         void* input, void* output, size_t count, size_t elem_size,
-                        bool elem_is_float, size_t* out_kept);
+                        bool elem_is_float, size_t* out_kept, bool scatter_needs_kept = false);
     // Partition reuses launch_compact: passing the partition scatter kernel (which
-    // reads num_true and writes every element) turns compaction into a partition.
+    // reads num_true and writes every element) with scatter_needs_kept = true turns
+    // compaction into a partition. num_true is a push constant, so the scatter then
+    // runs as a second submission after the kept count is read back.
 
-    // Synchronize all pending operations
+    // Synchronize all pending operations of the calling thread (flushing deferred
+    // launches first): one wait for the timeline to reach the thread's last submission
+    // (its fences, one by one, without a timeline). Also runs every completion callback
+    // that thread queued with when_complete().
     void sync();
 
+    // Deferred submission (backs PARALLAX_LAZY). While enabled, a launch leaves the
+    // calling thread's command buffer open instead of submitting it: the next launch
+    // appends to the same recording, behind a barrier only if it reads a range an
+    // earlier launch there writes or writes one an earlier launch accesses (see
+    // HazardTracker), so independent launches overlap on the device. flush() submits
+    // everything queued so far as one vkQueueSubmit. Any launch made with deferral off,
+    // sync(), wait_for()/is_complete(), a graph capture or replay, and every
+    // kMaxDeferredLaunches-th deferred launch flush implicitly. Epilogues queued with
+    // when_complete() meanwhile run once the flushed submission completes. Per thread.
+    void set_deferred(bool enabled) { ctx().deferred = enabled; }
+    void flush();
+    // Staging-arena migration of a deferred recording (used by ArenaSyncScope). A staged
+    // recording was migrated to the device when it opened, so its later launches skip
+    // that; each submission of it migrates back once it completes.
+    bool deferring() { return ctx().deferred; }
+    bool recording_staged() { ThreadContext& c = ctx(); return c.arena_staged && c.deferred_launches > 0; }
+    void stage_recording(bool staged) { ctx().arena_staged = staged; }
+
+    // Priority class of the calling thread's launches (see LaunchPriority). Changing it
+    // finishes what the thread has in flight, then moves it to a queue of the new
+    // class; not while the thread captures a graph.
+    void set_priority(LaunchPriority priority);
+    LaunchPriority priority() { return ctx().priority; }
+
+    // Tear down the calling thread's context: finish its work (running its completion
+    // callbacks), free its graphs and Vulkan objects and give its queue back. Runs by
+    // itself when a thread that launched exits; a later launch on the thread starts a
+    // fresh context.
+    void release_thread();
+
+    // Opt-in asynchronous submission (backs the C ABI streams/events). While enabled,
+    // launches return right after vkQueueSubmit instead of waiting on the fence, and
+    // host-side epilogues (scalar result copies, scratch frees, migrations back to the
+    // host) are deferred with when_complete() until the work is known to be done, so
+    // pointer outputs (launch_reduce's out_result, launch_compact's out_kept) must stay
+    // valid until then. Each submission gets a monotonically increasing serial;
+    // last_submission() is the most recent one. Submissions rotate through a ring of
+    // kFramesInFlight command buffers, so up to that many can be in flight while the
+    // host records the next. On a staging (non-UMA) arena the whole-arena flush before
+    // a launch still waits for in-flight work first. Async mode, serials and callbacks
+    // are per thread: a serial is only meaningful to the thread that submitted it.
+    void set_async(bool enabled) { ctx().async = enabled; }
+    bool async() { return ctx().async; }
+    // (Deferred launches already count: their serial is the one the flush will take.)
+    uint64_t last_submission() { return ctx().submit_serial + (ctx().deferred_launches ? 1 : 0); }
+
+    // Non-blocking completion test for a submission serial (0 is always complete).
+    // Reaps the fence and runs pending callbacks when it finds the work finished.
+    bool is_complete(uint64_t serial);
+    // Block until the submission with `serial` (and everything before it) completed.
+    void wait_for(uint64_t serial);
+    // Run `fn` once all submitted work has completed: immediately when nothing is in
+    // flight, otherwise when the newest submission's frame is retired.
+    void when_complete(std::function<void()> fn);
+    // Run `fn` once the work recorded so far can no longer execute: like when_complete
+    // for an ordinary launch, but deferred to destroy_graph() for a launch captured into
+    // a graph (which reuses its scratch on every replay). Frees go here, result copies
+    // in when_complete.
+    void when_retired(std::function<void()> fn);
+
+    // Launch graphs. Between begin_capture() and end_capture() the calling thread's
+    // launches are recorded, not executed: every node goes into one reusable command
+    // buffer, with a barrier only where a node's access to a storage range conflicts
+    // with an earlier node's since the last barrier (read-after-write, write-after-read
+    // or write-after-write; see HazardTracker). launch_graph() replays it as a single
+    // vkQueueSubmit, honouring set_async like any launch. What a graph binds is fixed at capture, so its buffers
+    // must outlive it, and result pointers (reduce value, kept count) are written again
+    // on every replay. Capture blocks move into graph-owned uniforms, patchable between
+    // replays with set_graph_captures() (index = order of capture); scalars that travel
+    // as push constants (counts, init values, inline captures) are baked in and take
+    // no index. Host code between captured
+    // launches runs once, at capture, and launches that read results on the host
+    // mid-operation (argmin/argmax, find, mismatch, partition) abort the capture, as
+    // does abort_capture(); end_capture() then returns nullptr. A graph belongs to the
+    // capturing thread: replay, patch and destroy it there.
+    struct Graph;
+    bool begin_capture();
+    Graph* end_capture();
+    bool capturing();
+    void abort_capture(const char* reason);
+    bool launch_graph(Graph* graph);
+    bool set_graph_captures(Graph* graph, size_t index, const void* data, size_t size);
+    void destroy_graph(Graph* graph);
+
+    // Replay cache. Iterative code runs the same capturing launch (launch_with_captures,
+    // launch_transform) over the same arena ranges thousands of times. The second time
+    // a thread issues a launch with the same (kernel, bound ranges, count, captures
+    // size) it is captured into a private graph whose command buffer is
+    // SIMULTANEOUS_USE; every later repeat only rewrites that graph's captures block
+    // (when the bytes changed, after its previous replay completed) and resubmits it:
+    // no descriptor update, push-constant rebuild or command recording. Inline
+    // captures are part of the recording, so they are part of the key. Launches that
+    // are deferred, captured into a graph, bind non-arena buffers, or would still be
+    // timed by the workgroup tuner run as usual. kReplayCacheEntries keys per thread,
+    // least recently used evicted first; PARALLAX_NO_REPLAY_CACHE=1 turns it off.
+    static constexpr size_t kReplayCacheEntries = 32;
+
 private:
-    // One level of the iterative reduction: bind src@0 / dst@1, dispatch `groups`
-    // workgroups over `count` elements. src/dst are already resolved to a VkBuffer
-    // plus byte offset/range (arena zero-copy or registered external buffer).
-    bool dispatch_reduce_level(PipelineData& pipeline_data,
-                               VkBuffer src_buf, VkDeviceSize src_off, VkDeviceSize src_range,
-                               VkBuffer dst_buf, VkDeviceSize dst_off, VkDeviceSize dst_range,
-                               uint32_t count, uint32_t groups);
-
-    // One bitonic compare-exchange stage: bind `data` at binding 0 (and a dummy at
-    // 1/2 to complete the shared layout), push { count, k, j }, dispatch `groups`
-    // workgroups. The kernel swaps each in-pair element with its i^j partner.
-    bool dispatch_sort_stage(PipelineData& pipeline_data,
-                             VkBuffer data_buf, VkDeviceSize data_off, VkDeviceSize data_range,
-                             uint32_t count, uint32_t k, uint32_t j, uint32_t groups);
-
-    // Exclusive-scan finalize: bind in@0 (inclusive scan), out@1 (+ dummy uniform@2),
-    // push { uint count@0, elem init@8 } (init_bytes = elem_size), dispatch `groups`
-    // workgroups. Writes out[i] = init + (i>0 ? in[i-1] : 0).
-    bool dispatch_exclusive_shift(PipelineData& pipeline_data,
-                                  VkBuffer in_buf, VkDeviceSize in_off, VkDeviceSize in_range,
-                                  VkBuffer out_buf, VkDeviceSize out_off, VkDeviceSize out_range,
-                                  uint32_t count, const void* init, size_t init_bytes,
-                                  uint32_t groups);
-
-    // Compaction scatter: bind input@0, output@1, positions@3 (+ dummy uniform@2),
-    // push { count }, dispatch `groups` workgroups. Writes each kept element to its
-    // compacted slot. Needs the 3-storage descriptor layout (binding 3).
-    bool dispatch_scatter(PipelineData& pipeline_data,
-                          VkBuffer in_buf, VkDeviceSize in_off, VkDeviceSize in_range,
-                          VkBuffer out_buf, VkDeviceSize out_off, VkDeviceSize out_range,
-                          VkBuffer pos_buf, VkDeviceSize pos_off, VkDeviceSize pos_range,
-                          uint32_t count, uint32_t groups, uint32_t num_true = 0);
+    // Binding 2 for kernels that do not read captures: one persistent zero-filled
+    // uniform created with the launcher, shared by every dispatch on every thread and
+    // never written afterwards (so binding it while in flight is safe).
+    VkDescriptorBufferInfo zero_uniform() const {
+        return VkDescriptorBufferInfo{zero_uniform_buffer_, 0, kZeroUniformSize};
+    }
+    // Copy `size` bytes of captures into the calling thread's capture ring and return
+    // the binding (at least kZeroUniformSize bytes, zero padded). Blocks are carved
+    // from the segment of the frame being recorded at minUniformBufferOffsetAlignment
+    // and recycled wholesale when that frame retires; a block that does not fit falls
+    // back to a dedicated buffer owned by the frame.
+    VkDescriptorBufferInfo upload_captures(const void* data, size_t size);
 
-    VulkanBackend* backend_;
-    MemoryManager* memory_manager_;
-    
-    // Pipeline cache
-    std::unordered_map<std::string, PipelineData> pipelines_;
-    
-    // Descriptor Set Cache: key is (descriptor_set_layout, buffer_ptr)
+    // Create a host-visible, host-coherent buffer (bound to its own allocation) and,
+    // when `mapped` is non-null, map it persistently. Returns false on failure.
+    bool create_host_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                            VkBuffer& buffer, VkDeviceMemory& memory, void** mapped);
+
+    // What one dispatch binds in the shared layout: storage@0, storage@1, uniform@2 and
+    // storage@3, each present when its bit is set in `mask` (a kernel needs only the
+    // bindings it statically uses). A plain value: nothing is allocated until it is
+    // recorded, so it can be planned ahead and recorded into several submissions.
+    struct Bindings {
+        VkDescriptorBufferInfo buffers[4]{};
+        uint32_t mask = 0;
+        // Storage bindings the launch path knows it only reads (a transform's input, a
+        // reduction's source), on top of the kernel's readonly_bindings.
+        uint32_t reads = 0;
+
+        Bindings() = default;
+        Bindings(const VkDescriptorBufferInfo& b0, const VkDescriptorBufferInfo& b1,
+                 const VkDescriptorBufferInfo& uniform, const VkDescriptorBufferInfo* b3 = nullptr) {
+            set(0, b0);
+            set(1, b1);
+            set(2, uniform);
+            if (b3) set(3, *b3);
+        }
+        void set(uint32_t binding, const VkDescriptorBufferInfo& info) {
+            buffers[binding] = info;
+            mask |= 1u << binding;
+        }
+    };
+
+    // Descriptor cache key of the pooled fallback: (descriptor_set_layout, buffer_ptr)
     struct CacheKey {
         VkDescriptorSetLayout layout;
         void* buffer;
+        VkDeviceSize range = 0;  // bound range, where a cached set is keyed by it
         bool operator==(const CacheKey& other) const {
-            return layout == other.layout && buffer == other.buffer;
+            return layout == other.layout && buffer == other.buffer && range == other.range;
         }
     };
     struct CacheHash {
         std::size_t operator()(const CacheKey& k) const {
-            return std::hash<void*>{}(k.buffer) ^ (std::hash<uint64_t>{}((uint64_t)k.layout) << 1);
+            return std::hash<void*>{}(k.buffer) ^ (std::hash<uint64_t>{}((uint64_t)k.layout) << 1) ^
+                   (std::hash<uint64_t>{}(k.range) << 2);
         }
     };
-    std::unordered_map<CacheKey, VkDescriptorSet, CacheHash> descriptor_cache_;
+
+    // How one dispatch is sized: the pipeline variant, its workgroup size and the number
+    // of workgroups covering the elements. plan_dispatch() takes the tuned size for
+    // (kernel, problem-size bucket) -- the kernel's own size when it has no variants or
+    // tuning is off -- and marks the launches the tuner wants timed. With `partner`,
+    // only sizes both kernels offer are considered (the scan kernel and its add kernel
+    // index the same blocks, so they must share one size); the pair is tuned as one.
+    // `timed` = false never samples. The groups are laid out as a groups_x x groups_y
+    // grid (shape_grid): a single row unless they exceed maxComputeWorkGroupCount[0].
+    struct Dispatch {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        uint32_t size = 256;
+        uint32_t groups = 0;
+        uint32_t groups_x = 0;
+        uint32_t groups_y = 1;
+        uint64_t kernel = 0;     // tuning key (SPIR-V hash, combined for a pair)
+        uint32_t bucket = 0;
+        bool sample = false;     // time this dispatch for the tuner
+    };
+    Dispatch plan_dispatch(const PipelineData& pipeline_data, size_t count,
+                           const PipelineData* partner = nullptr, bool timed = true);
+    void shape_grid(Dispatch& dispatch) const;
+    // Dispatch limits. max_groups() is the grid one dispatch of the kernel may have
+    // (a single row unless it is grid_2d). dispatch_limit() is the elements one
+    // dispatch covers: the grid at the kernel's smallest workgroup size, at most 2^31
+    // (32-bit invocation indices stay exact), and at most maxStorageBufferRange bytes
+    // of `elem_size`-byte elements per bound array. check_dispatch_limit() reports a
+    // count over it (for `tag`) for the paths that cannot be chunked.
+    uint64_t max_groups(const PipelineData& pipeline_data) const;
+    size_t dispatch_limit(const PipelineData& pipeline_data, size_t elem_size) const;
+    bool check_dispatch_limit(const char* tag, const PipelineData& pipeline_data,
+                              size_t count, size_t elem_size) const;
+    // A PushBlock dispatch over `count` elements: one dispatch when dispatch_limit()
+    // allows, else consecutive chunks of that many elements. Chunk i rebinds binding b
+    // at its offset plus per_element[b] bytes per element and per_group[b] bytes per
+    // workgroup of the chunks before it (bindings with both zero stay as they are),
+    // and pushes its own count and base, followed by `inline_size` bytes of inline
+    // captures when given. Returns the workgroups recorded in total.
+    struct ChunkStrides {
+        VkDeviceSize per_element[4]{};
+        VkDeviceSize per_group[4]{};
+    };
+    size_t record_chunked(const PipelineData& pipeline_data, const Bindings& bindings,
+                          const ChunkStrides& strides, size_t count, const CacheKey* key = nullptr,
+                          const void* inline_captures = nullptr, size_t inline_size = 0);
+    // Whether `capture_size` bytes of captures fit the kernel's inline room (reports
+    // them under `tag` when they do not).
+    bool check_inline_captures(const char* tag, const PipelineData& pipeline_data, size_t capture_size) const;
+    // Replay cache (see kReplayCacheEntries). What identifies a launch: its kernel,
+    // the arena ranges it binds at 0 and 1 (offset and size; zero when unbound), its
+    // count, and its captures (only their size for a uniform block, which is patched
+    // in place; the bytes themselves when they are pushed inline).
+    struct ReplayKey {
+        const PipelineData* pipeline = nullptr;
+        VkDeviceSize offsets[2]{};
+        VkDeviceSize sizes[2]{};
+        size_t count = 0;
+        size_t capture_size = 0;
+        std::vector<unsigned char> inline_captures;
+        bool operator==(const ReplayKey& other) const = default;
+    };
+    struct ReplayEntry {
+        ReplayKey key;
+        PipelineHandle kernel;           // keeps key.pipeline alive
+        Graph* graph = nullptr;          // recorded on the second launch
+        uint32_t launches = 0;
+        uint64_t last_use = 0;
+        std::vector<unsigned char> captures;  // current contents of the graph's block
+    };
+    // Run the launch `record` records through the calling thread's replay cache: as
+    // usual the first time (and whenever it cannot be cached), captured into the
+    // entry's graph the second, replayed after that. `key` carries the kernel, ranges
+    // and count; the captures are added here. `elem_size` is the widest element size
+    // of the launch (it sets the dispatch limit).
+    bool replay_launch(const PipelineHandle& kernel, ReplayKey key, size_t elem_size,
+                       const void* captures, size_t capture_size, const std::function<bool()>& record);
+    // Whether the tuner has settled the workgroup size of a launch of `count`
+    // elements, so a recording of it will not go stale (untuned kernels, chunked
+    // launches and a disabled tuner never change size).
+    bool tuning_settled(const PipelineData& pipeline_data, size_t count, size_t elem_size) const;
+    // The launch bodies behind the replay cache.
+    bool record_transform(const PipelineHandle& kernel, void* in_buffer, void* out_buffer, size_t count,
+                          size_t elem_size, size_t out_elem_size, void* captures, size_t capture_size);
+    bool record_with_captures(const PipelineHandle& kernel, void* buffer, size_t count,
+                              void* captures, size_t capture_size, size_t elem_size);
+    // begin_capture()/end_capture() without the diagnostics: start a graph whose command
+    // buffer is begun with `usage`, and finish it (nullptr when it failed or is empty).
+    bool open_graph(VkCommandBufferUsageFlags usage);
+    Graph* close_graph();
+
+    // Tuning samples: timestamps written around a dispatch (or a whole sort schedule)
+    // into the query pair reserved from the frame being recorded, read when the frame
+    // retires and reported to the tuner. begin_timing() returns the pair's first query,
+    // or kNoTiming when none can be taken (capturing, no timestamps, frame full), in
+    // which case the sample is cancelled.
+    static constexpr uint32_t kNoTiming = UINT32_MAX;
+    uint32_t begin_timing(const Dispatch& dispatch);
+    void end_timing(uint32_t query);
+
+    // Command recording helpers shared by every launch path. begin_commands() acquires
+    // the next frame of the calling thread's ring (waiting only if that frame is still
+    // in flight) and starts a one-time recording into its command buffer;
+    // submit_commands() ends, submits with the frame's fence under the queue lock,
+    // bumps the submission serial and (unless async) waits (`tag` prefixes the error
+    // message). A recording in which a descriptor set could not be allocated is
+    // dropped instead: submit_commands() then returns false. With deferral on, both
+    // keep appending to the open recording instead (see set_deferred). record_dispatch() binds
+    // the dispatch's pipeline variant + bindings, pushes `push_size` bytes at offset 0
+    // and dispatches the dispatch's grid (timed when it is a tuning sample, see
+    // record_grid). An address-ABI kernel gets its storage bindings as addresses.
+    void begin_commands();
+    bool submit_commands(const char* tag);
+    // End the frame's recording and submit it (or drop it when recording failed).
+    bool submit_recording(const char* tag);
+    // Submit `cmd` through VulkanBackend::submit, completing at the acquired frame's
+    // timeline value (else its fence, reset by the caller), and account for it as that
+    // frame's submission; waits unless async.
+    bool queue_submit(VkCommandBuffer cmd, const char* tag);
+    void record_dispatch(const PipelineData& pipeline_data, const Bindings& bindings,
+                         const void* push, uint32_t push_size, const Dispatch& dispatch,
+                         const CacheKey* key = nullptr);
+    void record_grid(const Dispatch& dispatch);
+    // Push `push` (at most kPushHeaderSize bytes) followed by the device addresses of
+    // `count` arena ranges, for an address-ABI kernel. A range outside the arena (or
+    // an arena without a device address) drops the recording like a failed descriptor
+    // allocation does, and returns false.
+    bool push_addresses(const PipelineData& pipeline_data, const void* push, uint32_t push_size,
+                        const VkDescriptorBufferInfo* ranges, uint32_t count);
+    // Record `bindings` for the next dispatches of the bound pipeline. With
+    // VK_KHR_push_descriptor they are written straight into the command buffer (no
+    // allocation, no pool limit, no cache lookup). The pooled fallback allocates a set
+    // from the frame's descriptor pools (see allocate_frame_set), or, when `key` is
+    // given, reuses the set cached under it (only for bindings that never reference
+    // frame-owned buffers).
+    bool bind_descriptors(const PipelineData& pipeline_data, const Bindings& bindings,
+                          const CacheKey* key = nullptr);
+    // Pooled fallback: a single-use set from the pools of the frame being recorded.
+    // Allocation moves on to the frame's next pool when one is exhausted, creating it
+    // on first need; retiring the frame resets every pool it used at once. Returns
+    // VK_NULL_HANDLE only when a new pool cannot be created.
+    // While capturing, sets come from the graph's own pools instead (kept until the
+    // graph is destroyed).
+    VkDescriptorSet allocate_frame_set(VkDescriptorSetLayout layout);
+    VkDescriptorPool create_descriptor_pool(uint32_t max_sets);
+
+    // Record a copy of `size` bytes at src/src_off into the host-visible result slot
+    // of the frame being recorded (with the compute->transfer->host barriers). Returns
+    // the slot's host address, readable once the submission completes and valid until
+    // the frame is reused, or nullptr when the slot is unavailable or too small; the
+    // caller then falls back to migrating the arena.
+    const void* record_result_readback(VkBuffer src, VkDeviceSize src_off, VkDeviceSize size);
+
+    // Scan planner. A multi-level inclusive scan of `count` elements has one level per
+    // workgroup-size reduction: level i scans count_i elements in place and writes
+    // groups_i block totals, which are level i+1's data. plan_scan() computes every level
+    // (each sized for the scan/add pair, see plan_dispatch),
+    // takes one arena allocation for all block sums, and fills each level's scan/add
+    // bindings; record_scan() records the scan down-sweep and add up-sweep with
+    // barriers into the current command buffer. The caller frees plan.scratch after
+    // the submission completes. count <= 1 yields an empty plan.
+    struct ScanLevel {
+        Bindings bindings;         // data@0, block sums@1 (scan and add kernels alike)
+        uint32_t count;
+        Dispatch scan;             // scan.groups block totals
+        Dispatch add;              // same size and groups, the add kernel's variant
+    };
+    struct ScanPlan {
+        std::vector<ScanLevel> levels;
+        void* scratch = nullptr;   // arena block holding every level's block sums
+    };
+    bool plan_scan(const PipelineData& scan_pd, const PipelineData& add_pd,
+                   const VkDescriptorBufferInfo& data, size_t count, size_t elem_size,
+                   ScanPlan& plan);
+    void record_scan(const ScanPlan& plan, const PipelineData& scan_pd, const PipelineData& add_pd);
+    // Whether a long multi-pass primitive on this thread ends its current bounded
+    // submission here: always at Low priority, at Normal while High-priority
+    // submissions are in flight (asked again at every split point). Between them the
+    // device (and, for synchronous launches, the host's queue order) lets
+    // high-priority work in. Never while capturing a graph.
+    bool split_long_work();
+
+    // The full bitonic schedule: bind `data` at binding 0 (and a dummy at 1/2 to
+    // complete the shared layout) once, then record one compare-exchange dispatch per
+    // (k,j) stage with push { count, k, j } and a compute barrier between stages.
+    // Submits once, or after kSplitWork of stages when split_long_work() (even under
+    // deferral, so the bounds are real submissions); not while it is timed. The kernel
+    // swaps each in-pair element with its i^j partner. A tuning sample times the whole
+    // schedule (a split one is not sampled).
+    bool dispatch_sort_schedule(const PipelineData& pipeline_data,
+                                VkBuffer data_buf, VkDeviceSize data_off, VkDeviceSize data_range,
+                                uint32_t count, const Dispatch& dispatch);
+
+    VulkanBackend* backend_;
+    MemoryManager* memory_manager_;
     
-    VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
-    VkCommandPool command_pool_ = VK_NULL_HANDLE;
-    VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
-    VkFence fence_ = VK_NULL_HANDLE;
-    bool fence_signaled_ = true;
-
-    // Per-launch scratch buffers (capture uniforms). Retired and destroyed by
-    // retire_transient_buffers() once prior work has completed, and at teardown,
-    // so they are not leaked past device destruction.
-    std::vector<std::pair<VkBuffer, VkDeviceMemory>> transient_buffers_;
-    void retire_transient_buffers();
+    // Every pipeline loaded so far, for teardown only (launches use their handles).
+    std::vector<PipelineHandle> pipelines_;
+    std::mutex pipelines_mutex_;
+
+    // vkCmdPushDescriptorSetKHR when the device supports push descriptors (see
+    // bind_descriptors); fixed at construction, since descriptor set layouts are
+    // created with the push flag only in that mode.
+    PFN_vkCmdPushDescriptorSetKHR push_descriptor_ = nullptr;
+
+    // Workgroup-size tuning (see WorkgroupTuner): null when disabled
+    // (PARALLAX_NO_AUTOTUNE) or when the compute queue has no timestamps, and then
+    // every kernel runs at its own size. Candidate sizes a variant may be built at
+    // (powers of two within the device's workgroup limits), and the mask/period that
+    // turn a timestamp pair into nanoseconds.
+    std::unique_ptr<WorkgroupTuner> tuner_;
+    bool replay_cache_ = true;  // off with PARALLAX_NO_REPLAY_CACHE
+    std::vector<uint32_t> workgroup_candidates_;
+    uint64_t timestamp_mask_ = 0;
+    double timestamp_period_ = 1.0;
+
+    // Frames-in-flight ring. Each submission records into one frame's command buffer
+    // and signals that frame's fence. A frame is reused only after its fence signaled;
+    // retiring it runs its completion callbacks and destroys the transient buffers that
+    // only its submission referenced. Recording submission k+1 thus overlaps execution
+    // of submission k, and frames retire in serial order so callbacks do too.
+    static constexpr uint32_t kFramesInFlight = 3;
+    // Persistently mapped host-visible slot for scalar results, one per frame (see
+    // record_result_readback). 16 bytes covers any element type we reduce/scan.
+    static constexpr VkDeviceSize kResultSlotSize = 16;
+    // Binding-2 sizes: the shared zero uniform, and each frame's capture ring segment
+    // (plenty for the few captures blocks a submission binds).
+    static constexpr VkDeviceSize kZeroUniformSize = 64;
+    static constexpr VkDeviceSize kCaptureSegmentSize = 16384;
+    // Pooled fallback: sets per frame descriptor pool (a frame adds pools as needed),
+    // and sets in the per-thread pool that backs the descriptor cache.
+    static constexpr uint32_t kFramePoolSets = 256;
+    static constexpr uint32_t kCachePoolSets = 1024;
+    // Deferred launches recorded into one submission before it is flushed regardless,
+    // bounding the recording (and the frame's descriptor pools and capture segment).
+    static constexpr uint32_t kMaxDeferredLaunches = 64;
+    // Work (elements x passes) of one submission of a split long primitive, see
+    // split_long_work(): about 64M element visits, a few milliseconds on a GPU.
+    static constexpr uint64_t kSplitWork = uint64_t(1) << 26;
+    // Tuning samples one submission can time (query pairs per frame).
+    static constexpr uint32_t kFrameTimings = 8;
+    VkBuffer zero_uniform_buffer_ = VK_NULL_HANDLE;
+    VkDeviceMemory zero_uniform_memory_ = VK_NULL_HANDLE;
+    struct Frame {
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        bool pending = false;   // submitted, completion not yet observed
+        uint64_t serial = 0;    // submission serial while pending
+        uint64_t timeline = 0;  // timeline value its submission signals (0: fence only)
+        bool high = false;      // a High-priority submission, counted by the backend until retired
+        VkBuffer result_buffer = VK_NULL_HANDLE;
+        VkDeviceMemory result_memory = VK_NULL_HANDLE;
+        void* result_mapped = nullptr;
+        std::vector<std::function<void()>> completions;
+        std::vector<std::pair<VkBuffer, VkDeviceMemory>> transients;
+        // Pooled fallback: descriptor pools for this frame's single-use sets, reset
+        // wholesale on retire. pools[pool_index] is the one being allocated from.
+        std::vector<VkDescriptorPool> pools;
+        uint32_t pool_index = 0;
+        bool record_failed = false;         // a set allocation failed while recording
+        bool result_used = false;           // result slot taken by this recording
+        VkDeviceSize capture_used = 0;      // bytes taken from this frame's capture segment
+        // Tuning samples recorded into this frame, in query-pair order.
+        struct Timing {
+            uint64_t kernel;
+            uint32_t bucket;
+            uint32_t size;
+            uint32_t query;
+        };
+        std::vector<Timing> timings;
+    };
+
+    // RAW/WAR/WAW tracking within one recording that holds several launches (a graph
+    // being captured, or a thread's open deferred recording). `done` holds the storage
+    // ranges the launches since the last barrier accessed, `node` those of the launch
+    // being recorded. An access waits (a barrier is recorded first) only when it writes
+    // a range that `done` touches, or reads one that `done` writes: launches that share
+    // nothing, or only read what they share, run with no barrier between them.
+    struct HazardTracker {
+        struct Range {
+            VkBuffer buffer;
+            VkDeviceSize begin;
+            VkDeviceSize end;
+            bool write;
+        };
+        std::vector<Range> done;
+        std::vector<Range> node;
+        uint32_t barriers = 0;  // recorded since reset()
+
+        // Start the next launch: the previous one's ranges join `done`.
+        void next_node() {
+            done.insert(done.end(), node.begin(), node.end());
+            node.clear();
+        }
+        void reset() {
+            done.clear();
+            node.clear();
+            barriers = 0;
+        }
+    };
+
+    // Per-thread launch context: everything a launch records into or mutates. Only
+    // its owning thread touches it after creation, so none of it is locked. A context
+    // lives until its thread exits (see release_thread) or the launcher is destroyed.
+    struct ThreadContext {
+        VkCommandPool command_pool = VK_NULL_HANDLE;
+        VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;  // cached sets (pooled fallback)
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;  // the frame being recorded
+        Frame frames[kFramesInFlight];
+        uint32_t frame_index = 0;      // frame being (or last) recorded
+        bool frame_acquired = false;   // frames[frame_index] reserved for the next submit
+        // Compute queue every submission of this thread goes to (chosen by
+        // VulkanBackend::acquire_queue for its priority), so its frames complete in
+        // serial order.
+        uint32_t queue = 0;
+        LaunchPriority priority = LaunchPriority::Normal;
+
+        // Async submission tracking. submit_serial counts submissions; complete_serial
+        // is the newest one observed finished.
+        bool async = false;
+        uint64_t submit_serial = 0;
+        uint64_t complete_serial = 0;
+
+        // Deferred submission: launches recorded into frames[frame_index] and not yet
+        // submitted (the recording is open while this is non-zero).
+        bool deferred = false;
+        uint32_t deferred_launches = 0;
+        bool arena_staged = false;  // see recording_staged()
+        // Ranges the open recording's launches accessed (tracked while it can still
+        // take more launches, see recording_hazards).
+        HazardTracker hazards;
+
+        // Pooled fallback only (no pool is created with push descriptors). Cached sets
+        // bind only data buffers and the shared zero uniform, so nothing they reference
+        // is owned by a frame.
+        std::unordered_map<CacheKey, VkDescriptorSet, CacheHash> descriptor_cache;
+
+        // Capture ring: kFramesInFlight segments of kCaptureSegmentSize bytes, segment i
+        // belonging to frames[i]; persistently mapped.
+        VkBuffer capture_buffer = VK_NULL_HANDLE;
+        VkDeviceMemory capture_memory = VK_NULL_HANDLE;
+        void* capture_mapped = nullptr;
+        VkDeviceSize capture_alignment = 256;  // minUniformBufferOffsetAlignment
+
+        // Timestamp queries of the tuning samples: kFrameTimings pairs per frame, the
+        // pairs of frames[i] starting at query 2 * kFrameTimings * i. Only with a tuner.
+        VkQueryPool timing_pool = VK_NULL_HANDLE;
+
+        // Launch graphs captured by this thread, and the one being captured (if any).
+        std::vector<std::unique_ptr<Graph>> graphs;
+        Graph* capture = nullptr;
+
+        // Replay cache (see kReplayCacheEntries); entries' graphs are in `graphs`.
+        std::vector<ReplayEntry> replays;
+        uint64_t replay_clock = 0;
+    };
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadContext>> contexts_;
+    std::mutex contexts_mutex_;
+    uint64_t instance_id_;  // tags the thread-local context cache (see ctx())
+
+    // The calling thread's context, created on first use. find_ctx() does not create
+    // one (nullptr for a thread that never launched).
+    ThreadContext& ctx();
+    ThreadContext* find_ctx();
+    std::unique_ptr<ThreadContext> create_context();
+    void destroy_context(ThreadContext& context);
+
+    // Reserve the frame the next submission records into, retiring its previous use.
+    Frame& acquire_frame();
+    // Drop what a frame's submission owned: transient buffers, single-use descriptor
+    // sets (by resetting the frame's pools) and its capture segment.
+    void release_frame(Frame& frame);
+    // Report the frame's tuning samples to the tuner, or cancel them when the
+    // recording never executed.
+    void collect_timings(Frame& frame, bool executed);
+    // Retire the calling thread's pending frames with serial <= `serial`, oldest
+    // first. With block = false stops at the first incomplete frame and returns false.
+    bool retire_through(uint64_t serial, bool block);
+    void destroy_buffers(std::vector<std::pair<VkBuffer, VkDeviceMemory>>& buffers);
+
+    // The tracker of the recording the calling thread's launch goes into: its graph
+    // capture, else its deferred recording, else nullptr (the launch is submitted on
+    // its own, after everything before it).
+    HazardTracker* recording_hazards();
+    // Add the storage ranges of a dispatch (or copy source) to the launch being
+    // recorded into `cmd`, first recording a barrier when one of them conflicts with an
+    // earlier launch's access since the last barrier. Bit i of `writes` marks ranges[i]
+    // as written.
+    void track_hazards(HazardTracker& tracker, VkCommandBuffer cmd, const VkDescriptorBufferInfo* ranges,
+                       uint32_t count, uint32_t writes);
+    void destroy_graph_resources(Graph& graph);
+};
+
+// A captured launch sequence (see begin_capture). Owns everything its recording refers
+// to besides the caller's buffers and the arena: the command buffer, the pooled
+// fallback's descriptor sets, capture blocks (the patchable parameters), readback slots
+// and the scratch its launches allocated.
+struct KernelLauncher::Graph {
+    ThreadContext* owner = nullptr;
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    std::vector<VkDescriptorPool> pools;
+    uint32_t pool_index = 0;
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> buffers;
+    struct Param {
+        void* mapped;
+        size_t size;
+    };
+    std::vector<Param> params;
+    std::vector<std::function<void()>> epilogues;  // after every replay (when_complete)
+    std::vector<std::function<void()>> releases;   // at destroy_graph (when_retired)
+
+    HazardTracker hazards;  // while recording; its barriers are the inter-launch ones
+    uint32_t nodes = 0;
+    bool failed = false;
+    // Recorded with SIMULTANEOUS_USE (a replay-cache graph): a replay may be submitted
+    // while the previous one is still executing.
+    bool simultaneous = false;
+    uint64_t serial = 0;  // owner's submission serial of the newest replay
 };
 
 } // namespace parallax
@@ -2,6 +2,7 @@
 #define PARALLAX_RUNTIME_H
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +32,15 @@ int parallax_heap_contains(const void* ptr);
 
 /* Kernel execution */
 parallax_kernel_t parallax_kernel_load(const unsigned int* spirv, size_t words);
+
+/* Kernel metadata flags (parallax_kernel_load_flags / parallax_kernel_register_flags).
+ * PARALLAX_KERNEL_INLINE_CAPTURES: the kernel reads its captures from the push-constant
+ * block at offset 32, right after the launch header (after its array addresses, for a
+ * descriptor-free kernel), instead of the uniform@2 block, which it must not declare.
+ * At least 96 bytes of captures fit (224 on devices with 256-byte push constants); a
+ * launch with more fails. The compiler sets it for closures that small. */
+#define PARALLAX_KERNEL_INLINE_CAPTURES 0x1u
+parallax_kernel_t parallax_kernel_load_flags(const unsigned int* spirv, size_t words, unsigned flags);
 void parallax_kernel_launch(parallax_kernel_t kernel, ...);
 void parallax_kernel_launch_transform(parallax_kernel_t kernel, ...);
 /* Transform with distinct input/output element sizes (e.g. float -> double). */
@@ -45,6 +55,36 @@ void parallax_kernel_launch_transform2_captures(parallax_kernel_t kernel, void*
                                                 size_t in_elem_size, size_t out_elem_size,
                                                 void* captures, size_t capture_size);
 
+/* Batched launches: every descriptor is recorded into one submission, which is waited on
+ * once. `in` binds at 0 and `out` at 1 (NULL for an in-place map); out_elem_size 0 means
+ * in_elem_size; captures are handled as in transform2_captures. `depends_on` bit k says
+ * the launch reads or overwrites what descs[i-1-k] wrote: only then is a barrier
+ * recorded before it, so launches with a zero mask may overlap the ones before them
+ * back to the last barrier. PARALLAX_DEPENDS_ALL orders a launch after every earlier
+ * one. A bad descriptor fails the whole batch before anything runs. */
+typedef struct parallax_launch_desc {
+    parallax_kernel_t kernel;
+    void* in;
+    void* out;
+    size_t count;
+    size_t in_elem_size;
+    size_t out_elem_size;
+    const void* captures;
+    size_t capture_size;
+    uint64_t depends_on;
+} parallax_launch_desc;
+#define PARALLAX_DEPENDS_ALL (~(uint64_t)0)
+void parallax_launch_batch(const parallax_launch_desc* descs, size_t n);
+
+/* Descriptor-free launch of a kernel that takes its arrays as physical storage buffer
+ * addresses in the push block (no descriptor bindings; see README). `arrays` must be
+ * arena-resident; elem_sizes[i] is the element size of arrays[i] (0 = not indexed per
+ * element). At most 12 arrays are guaranteed, 28 on devices with 256-byte push
+ * constants. */
+void parallax_kernel_launch_addressed(parallax_kernel_t kernel, size_t count,
+                                      void* const* arrays, const size_t* elem_sizes,
+                                      size_t num_arrays);
+
 /* Parallel reduction (Phase 3). Reduces `count` elements of `data` to a single
  * scalar using the loaded workgroup-reduction kernel, writing elem_size bytes to
  * `result`. The kernel uses the '+' identity (0); the caller combines any init.
@@ -93,6 +133,131 @@ size_t parallax_copy_if(parallax_kernel_t flags_kernel, parallax_kernel_t scan_k
                         void* input, void* output, size_t count, size_t elem_size,
                         int elem_is_float);
 
+/* Partition (Phase 5). Same pipeline as parallax_copy_if, but scatter_kernel is the
+ * partition scatter: it reads the kept count (push constant num_true) and writes every
+ * element, kept ones first. Returns num_true, the partition point. */
+size_t parallax_partition(parallax_kernel_t flags_kernel, parallax_kernel_t scan_kernel,
+                          parallax_kernel_t add_kernel, parallax_kernel_t scatter_kernel,
+                          void* input, void* output, size_t count, size_t elem_size,
+                          int elem_is_float);
+
+/* Asynchronous streams and events (opt-in). The *_async variants take a stream and
+ * return once their work is submitted instead of waiting for it. Host-side results --
+ * the reduce value, the copy_if kept count, the download of a registered (non-arena)
+ * buffer -- are written when the work completes, so `result`/`kept` must stay valid
+ * until an event recorded after the launch has been waited on or the stream has been
+ * synchronized. The streams of one host thread share that thread's compute queue,
+ * so work on different streams still runs in submission order. The synchronous entry
+ * points remain and first wait for any outstanding async work. A NULL stream means
+ * "all work".
+ * Submission state is per host thread: issue, record, wait on and query a stream's
+ * work from the thread that launched it (different threads use different streams).
+ * Threads are spread over the device's compute queues, so independent work from two
+ * threads may overlap; finish (synchronize) work before another thread reads its output. */
+typedef struct parallax_stream* parallax_stream_t;
+typedef struct parallax_event* parallax_event_t;
+
+parallax_stream_t parallax_stream_create(void);
+void parallax_stream_destroy(parallax_stream_t stream);
+/* Block until every launch issued on `stream` has completed and its results landed. */
+void parallax_stream_synchronize(parallax_stream_t stream);
+
+parallax_event_t parallax_event_create(void);
+void parallax_event_destroy(parallax_event_t event);
+/* Capture the work issued on `stream` so far; waiting on the event waits for it. */
+void parallax_event_record(parallax_event_t event, parallax_stream_t stream);
+void parallax_event_wait(parallax_event_t event);
+/* 1 if the recorded work has completed (results written), 0 otherwise. Never blocks. */
+int parallax_event_query(parallax_event_t event);
+
+/* How the host waits for submitted work (every blocking call above, and the arena's
+ * migrations). PARALLAX_WAIT_LATENCY polls the completion for a short time adapted to
+ * recent waits before sleeping, which cuts the wake-up delay of short kernels at the
+ * cost of a busy core while polling; PARALLAX_WAIT_EFFICIENT sleeps at once. The
+ * default is latency, or efficient on a CPU Vulkan implementation; PARALLAX_WAIT=
+ * latency|efficiency sets it at startup. Applies process-wide; any other value is
+ * logged and leaves the mode unchanged. */
+#define PARALLAX_WAIT_LATENCY 0
+#define PARALLAX_WAIT_EFFICIENT 1
+void parallax_set_wait_mode(int mode);
+
+/* Priority class of the calling thread's launches. HIGH is for latency-critical work
+ * (small maps and reductions on a request path), LOW for background batch work. Each
+ * class gets its own compute queue where the device has enough (HIGH from three queues,
+ * LOW from four), created with a matching queue priority. Below HIGH, a long sort is
+ * split into bounded submissions while HIGH launches are in flight (always at LOW, and
+ * also under PARALLAX_LAZY), so high-priority launches are not stuck behind it. A thread
+ * that is merely set to HIGH splits nothing. Changing the class first waits for
+ * the thread's outstanding work. Default: NORMAL. */
+#define PARALLAX_PRIORITY_LOW 0
+#define PARALLAX_PRIORITY_NORMAL 1
+#define PARALLAX_PRIORITY_HIGH 2
+void parallax_set_priority(int priority);
+
+void parallax_kernel_launch_async(parallax_stream_t stream, parallax_kernel_t kernel,
+                                  void* buffer, size_t count, size_t elem_size);
+void parallax_reduce_async(parallax_stream_t stream, parallax_kernel_t kernel, void* data,
+                           size_t count, size_t elem_size, void* result);
+void parallax_scan_async(parallax_stream_t stream, parallax_kernel_t scan_kernel,
+                         parallax_kernel_t add_kernel, void* data, size_t count, size_t elem_size);
+void parallax_sort_async(parallax_stream_t stream, parallax_kernel_t kernel, void* data,
+                         size_t count, size_t elem_size);
+void parallax_copy_if_async(parallax_stream_t stream, parallax_kernel_t flags_kernel,
+                            parallax_kernel_t scan_kernel, parallax_kernel_t add_kernel,
+                            parallax_kernel_t scatter_kernel, void* input, void* output,
+                            size_t count, size_t elem_size, int elem_is_float, size_t* kept);
+/* Async forms of parallax_kernel_launch_with_captures and
+ * parallax_kernel_launch_transform2_captures (NULL captures: a captureless transform). */
+void parallax_kernel_launch_with_captures_async(parallax_stream_t stream, parallax_kernel_t kernel,
+                                                void* buffer, size_t count, void* captures,
+                                                size_t capture_size, size_t elem_size);
+void parallax_kernel_launch_transform2_async(parallax_stream_t stream, parallax_kernel_t kernel,
+                                             void* in_buffer, void* out_buffer, size_t count,
+                                             size_t in_elem_size, size_t out_elem_size,
+                                             void* captures, size_t capture_size);
+
+/* Deferred execution. With PARALLAX_LAZY=1 set, the synchronous launches that return
+ * nothing to the host (parallax_kernel_launch*, parallax_scan, parallax_exclusive_scan,
+ * parallax_sort) are recorded into one open command buffer per host thread instead of
+ * being submitted and waited on one by one. A launch there waits on an earlier one only
+ * if it reads a range that launch writes, or writes a range it reads or writes; others
+ * run concurrently. A kernel's `readonly` buffers, a transform's input and a reduce's
+ * data count as read, every other bound buffer as written. The queue is submitted as a
+ * single batch when the host needs a result: a reduce or copy_if, any stream, event or
+ * graph call, a full batch, or parallax_flush(). Until then the output of a deferred launch is not
+ * visible to the host. parallax_flush() submits the queue and waits for everything the
+ * calling thread has submitted. Without PARALLAX_LAZY every launch completes before
+ * returning and parallax_flush() is a no-op. */
+void parallax_flush(void);
+
+/* Launch graphs. Between parallax_graph_begin() and parallax_graph_end(), the launches
+ * the calling thread issues are recorded instead of executed: into one reusable command
+ * buffer with fixed bindings, and a barrier only where a launch conflicts with an
+ * earlier launch of the graph in that same way. Each parallax_graph_launch() then
+ * replays the whole sequence as a single queue submission. Because bindings are fixed, the buffers
+ * of a captured launch must outlive the graph, and result pointers (the reduce
+ * `result`, the copy_if count) are written again on every replay. Capture blocks become
+ * graph parameters: parallax_graph_set_captures() rewrites the index-th captured block
+ * (in capture order) before the next replay. Counts and other scalars passed by value
+ * are baked in. Host code between captured launches runs once, during capture; launches
+ * that need their result on the host mid-operation (argmin/argmax, find, mismatch,
+ * partition) and freeing arena memory (the funnels' staging path) abort the capture,
+ * and parallax_graph_end() then returns NULL. A graph belongs to the capturing thread:
+ * replay, patch and destroy it there. Graphs still alive when that thread exits are
+ * destroyed with it. */
+typedef struct parallax_graph* parallax_graph_t;
+
+void parallax_graph_begin(void);
+parallax_graph_t parallax_graph_end(void);
+/* 1 while the calling thread is capturing a graph. */
+int parallax_graph_capturing(void);
+void parallax_graph_launch(parallax_graph_t graph);
+void parallax_graph_launch_async(parallax_stream_t stream, parallax_graph_t graph);
+/* Returns 1 on success, 0 if the graph has no such block or `size` exceeds it. */
+int parallax_graph_set_captures(parallax_graph_t graph, size_t index, const void* captures,
+                                size_t size);
+void parallax_graph_destroy(parallax_graph_t graph);
+
 /* Layer A funnel registry. The compiler plugin emits one registrar per
  * parallax::detail::device_invoke<T,F> instantiation, keyed by that
  * instantiation's __PRETTY_FUNCTION__; the funnel body looks the kernel up at
@@ -100,6 +265,9 @@ size_t parallax_copy_if(parallax_kernel_t flags_kernel, parallax_kernel_t scan_k
  * pointer; the SPIR-V is loaded lazily on first lookup (after runtime init), so
  * registrars may run at static-init time before the backend exists. */
 void parallax_kernel_register(const char* key, const unsigned int* spirv, size_t words);
+/* Same, with PARALLAX_KERNEL_* metadata flags for the load. */
+void parallax_kernel_register_flags(const char* key, const unsigned int* spirv, size_t words,
+                                    unsigned flags);
 parallax_kernel_t parallax_kernel_lookup(const char* key);
 
 /* NEW V2: Kernel execution with captured parameters */
@@ -136,6 +304,36 @@ template <class It>
 inline constexpr bool is_contiguous_iterator_v =
     std::is_pointer_v<std::remove_reference_t<It>>;
 #endif
+
+/* Scope of deferred work: flushes what PARALLAX_LAZY queued on this thread when it
+ * ends, so results written inside the scope are on the host after it. */
+class lazy_scope {
+public:
+    lazy_scope() = default;
+    ~lazy_scope() { parallax_flush(); }
+    lazy_scope(const lazy_scope&) = delete;
+    lazy_scope& operator=(const lazy_scope&) = delete;
+};
+
+/* Scoped graph capture: records the launches issued while it is alive. end() stops
+ * the capture and returns the graph (NULL on failure); a scope left without end()
+ * discards what it captured. */
+class graph_capture {
+public:
+    graph_capture() { parallax_graph_begin(); }
+    ~graph_capture() {
+        if (active_) parallax_graph_destroy(parallax_graph_end());
+    }
+    graph_capture(const graph_capture&) = delete;
+    graph_capture& operator=(const graph_capture&) = delete;
+    parallax_graph_t end() {
+        active_ = false;
+        return parallax_graph_end();
+    }
+
+private:
+    bool active_ = true;
+};
 }  // namespace parallax
 #endif /* __cplusplus */
 
@@ -15,6 +15,11 @@ MemoryManager* get_global_memory_manager();
 // device is available. Used by the opt-in allocation interposition (Phase 1d).
 UnifiedArena* get_global_arena();
 
+// End the calling thread's launch-graph capture without a graph (see
+// parallax_graph_begin), for a host operation a replay could not repeat. No-op when the
+// thread is not capturing.
+void abort_graph_capture(const char* reason);
+
 } // namespace parallax
 
 #endif // PARALLAX_RUNTIME_HPP
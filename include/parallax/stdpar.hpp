@@ -15,9 +15,20 @@
 // an element into a SPIR-V kernel, and (2) appends a registrar keyed by this
 // function's __PRETTY_FUNCTION__. At runtime the funnel looks that key up; a hit
 // dispatches to the GPU, a miss runs the ISO sequential loop (correct either way).
+//
+// Under PARALLAX_LAZY=1 the launches the funnels issue are deferred (runtime.h). Every
+// place a funnel touches memory on the host itself -- staging copies in and out of the
+// arena, the host fallback loops -- first calls parallax_flush(), so it never reads or
+// overwrites data a queued launch has yet to produce. Without PARALLAX_LAZY those calls
+// do nothing.
+//
+// parallax/async.hpp issues for_each/transform/reduce/sort/copy_if through the same
+// funnels from its completion thread, with detail::current_async set: the funnel then
+// launches on that stream and returns without waiting (see async_issue below).
 
 #include <cstddef>
 #include <cstring>
+#include <functional>
 #include <string>
 #include <iterator>
 #include <type_traits>
@@ -25,6 +36,7 @@
 #include <numeric>
 #include <limits>
 #include <execution>
+#include <vector>
 #include <parallax/runtime.h>
 
 namespace parallax {
@@ -38,6 +50,20 @@ inline constexpr parallel_unsequenced_policy par_unseq{};
 
 namespace detail {
 
+// An algorithm issued by parallax/async.hpp. While current_async points at one, the
+// funnels issue their launches on `stream` instead of waiting for them, and queue the
+// host work that has to follow (copying a staged output back, freeing arena scratch)
+// on `finish`, which runs once the stream's work completed. A value-returning funnel
+// that went to the device sets `pending` and leaves its value in `result` rather than
+// returning it. Host fallbacks ignore it and finish synchronously.
+struct async_issue {
+    parallax_stream_t stream = nullptr;
+    void* result = nullptr;
+    bool pending = false;
+    std::vector<std::function<void()>> finish;
+};
+inline thread_local async_issue* current_async = nullptr;
+
 // The single stable funnel. One instantiation per (element type T, functor F).
 // The plugin compiles this instantiation's `f(data[i])` body to SPIR-V and
 // registers it under __PRETTY_FUNCTION__ (which uniquely names this T,F pair and
@@ -47,37 +73,53 @@ template <class T, class F>
 __attribute__((noinline)) void device_invoke(T* data, std::size_t n, F f) {
     static parallax_kernel_t k = parallax_kernel_lookup(__PRETTY_FUNCTION__);
     if (k) {
-        // Zero-copy fast path (whole-heap model): when the data already lives in the
-        // unified arena / heap pool (a captured std::vector), the launcher binds it
-        // directly and the kernel writes IN PLACE — no staging copy at all.
-        if (parallax_arena_contains(data)) {
-            if constexpr (std::is_empty_v<F>) {
-                parallax_kernel_launch(k, data, n, sizeof(T));
+        async_issue* async = current_async;
+        auto launch = [&](void* buf) {
+            if (async) {
+                if constexpr (std::is_empty_v<F>) {
+                    parallax_kernel_launch_async(async->stream, k, buf, n, sizeof(T));
+                } else {
+                    parallax_kernel_launch_with_captures_async(async->stream, k, buf, n,
+                                                               static_cast<void*>(&f), sizeof(F),
+                                                               sizeof(T));
+                }
+            } else if constexpr (std::is_empty_v<F>) {
+                parallax_kernel_launch(k, buf, n, sizeof(T));
             } else {
-                parallax_kernel_launch_with_captures(k, data, n,
+                parallax_kernel_launch_with_captures(k, buf, n,
                                                      static_cast<void*>(&f), sizeof(F),
                                                      sizeof(T));
             }
+        };
+        // Zero-copy fast path (whole-heap model): when the data already lives in the
+        // unified arena / heap pool (a captured std::vector), the launcher binds it
+        // directly and the kernel writes IN PLACE — no staging copy at all.
+        if (parallax_arena_contains(data)) {
+            launch(data);
             return;
         }
         // Staging path: non-pool data (stack/static arrays, or a heap allocation made
         // before the pool existed) is copied through the arena. Correct on UMA + discrete.
         void* ab = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ab) {
+            parallax_flush();
             std::memcpy(ab, data, n * sizeof(T));
-            if constexpr (std::is_empty_v<F>) {
-                parallax_kernel_launch(k, ab, n, sizeof(T));
-            } else {
-                parallax_kernel_launch_with_captures(k, ab, n,
-                                                     static_cast<void*>(&f), sizeof(F),
-                                                     sizeof(T));
+            launch(ab);
+            if (async) {
+                async->finish.push_back([data, ab, n] {
+                    std::memcpy(data, ab, n * sizeof(T));
+                    parallax_arena_free(ab);
+                });
+                return;
             }
+            parallax_flush();
             std::memcpy(data, ab, n * sizeof(T));
             parallax_arena_free(ab);
             return;
         }
     }
     // Host fallback (ISO semantics) — also the path when codegen bailed.
+    parallax_flush();
     for (std::size_t i = 0; i < n; ++i) f(data[i]);
 }
 
@@ -89,8 +131,13 @@ template <class Tin, class Tout, class F>
 __attribute__((noinline)) void device_transform(const Tin* in, Tout* out, std::size_t n, F f) {
     static parallax_kernel_t k = parallax_kernel_lookup(__PRETTY_FUNCTION__);
     if (k) {
+        async_issue* async = current_async;
         auto launch2 = [&](void* ib, void* ob) {
-            if constexpr (std::is_empty_v<F>) {
+            if (async) {
+                void* captures = std::is_empty_v<F> ? nullptr : static_cast<void*>(&f);
+                parallax_kernel_launch_transform2_async(async->stream, k, ib, ob, n, sizeof(Tin),
+                                                        sizeof(Tout), captures, sizeof(F));
+            } else if constexpr (std::is_empty_v<F>) {
                 parallax_kernel_launch_transform2(k, ib, ob, n, sizeof(Tin), sizeof(Tout));
             } else {
                 // Capturing transform op: bind the closure bytes as the uniform@2 block
@@ -108,14 +155,25 @@ __attribute__((noinline)) void device_transform(const Tin* in, Tout* out, std::s
         void* ai = parallax_arena_alloc(n * sizeof(Tin), alignof(Tin));
         void* ao = parallax_arena_alloc(n * sizeof(Tout), alignof(Tout));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, in, n * sizeof(Tin));
             launch2(ai, ao);
+            if (async) {
+                async->finish.push_back([out, ai, ao, n] {
+                    std::memcpy(out, ao, n * sizeof(Tout));
+                    parallax_arena_free(ao);
+                    parallax_arena_free(ai);
+                });
+                return;
+            }
+            parallax_flush();
             std::memcpy(out, ao, n * sizeof(Tout));
             parallax_arena_free(ao);
             parallax_arena_free(ai);
             return;
         }
     }
+    parallax_flush();
     for (std::size_t i = 0; i < n; ++i) out[i] = f(in[i]);
 }
 
@@ -123,19 +181,39 @@ __attribute__((noinline)) void device_transform(const Tin* in, Tout* out, std::s
 // the fixed workgroup tree-reduction kernel for T (no per-element functor). The runtime
 // returns the pure GPU sum; we combine the caller's init on the host (matches the old
 // std::reduce path). MVP: default '+' only (custom-op reduce stays on the host).
+// Issued asynchronously, the GPU sum lands in *(T*)current_async->result and the caller
+// combines init itself.
 template <class T>
 __attribute__((noinline)) T device_reduce(const T* data, std::size_t n, T init) {
     static parallax_kernel_t k = parallax_kernel_lookup(__PRETTY_FUNCTION__);
     if (k) {
+        if (async_issue* async = current_async) {
+            const bool resident = parallax_arena_contains(data);
+            void* ab = resident ? nullptr : parallax_arena_alloc(n * sizeof(T), alignof(T));
+            if (resident || ab) {
+                if (ab) {
+                    parallax_flush();
+                    std::memcpy(ab, data, n * sizeof(T));
+                    async->finish.push_back([ab] { parallax_arena_free(ab); });
+                }
+                parallax_reduce_async(async->stream, k, ab ? ab : const_cast<T*>(data), n, sizeof(T),
+                                      async->result);
+                async->pending = true;
+                return init;
+            }
+        }
         // Zero-copy: reduce reads the input only, so pool-resident data is reduced in
         // place with no staging copy (the reduction uses its own arena scratch internally).
-        if (parallax_arena_contains(data)) {
+        // Not while capturing a graph: the result slot is this frame's `gpu`, which a
+        // replay would write after it is gone (the staging path aborts the capture).
+        if (parallax_arena_contains(data) && !parallax_graph_capturing()) {
             T gpu{};
             parallax_reduce(k, const_cast<T*>(data), n, sizeof(T), &gpu);
             return init + gpu;
         }
         void* ab = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ab) {
+            parallax_flush();
             std::memcpy(ab, data, n * sizeof(T));
             T gpu{};
             parallax_reduce(k, ab, n, sizeof(T), &gpu);
@@ -143,6 +221,7 @@ __attribute__((noinline)) T device_reduce(const T* data, std::size_t n, T init)
             return init + gpu;
         }
     }
+    parallax_flush();
     T acc = init;
     for (std::size_t i = 0; i < n; ++i) acc = acc + data[i];
     return acc;
@@ -160,21 +239,34 @@ __attribute__((noinline)) void device_sort(T* data, std::size_t n) {
         while (m < n) m <<= 1;                 // next power of two
         // Zero-copy: when the count is already a power of two AND the data is pool-resident,
         // bitonic-sort it in place — no padding buffer, no copies.
+        async_issue* async = current_async;
         if (m == n && parallax_arena_contains(data)) {
-            parallax_sort(k, data, n, sizeof(T));
+            if (async) parallax_sort_async(async->stream, k, data, n, sizeof(T));
+            else parallax_sort(k, data, n, sizeof(T));
             return;
         }
         void* ab = parallax_arena_alloc(m * sizeof(T), alignof(T));
         if (ab) {
             T* pad = static_cast<T*>(ab);
+            parallax_flush();
             std::memcpy(pad, data, n * sizeof(T));
             for (std::size_t i = n; i < m; ++i) pad[i] = (std::numeric_limits<T>::max)();
+            if (async) {
+                parallax_sort_async(async->stream, k, pad, m, sizeof(T));
+                async->finish.push_back([data, pad, n] {
+                    std::memcpy(data, pad, n * sizeof(T));
+                    parallax_arena_free(pad);
+                });
+                return;
+            }
             parallax_sort(k, pad, m, sizeof(T));
+            parallax_flush();
             std::memcpy(data, pad, n * sizeof(T));
             parallax_arena_free(ab);
             return;
         }
     }
+    parallax_flush();
     std::sort(data, data + n);
 }
 
@@ -192,20 +284,27 @@ __attribute__((noinline)) void device_scan(const T* in, T* out, std::size_t n) {
         // Zero-copy: the scan runs in place. If both input and output are pool-resident,
         // scan the output buffer directly (copying in->out first only when they differ),
         // avoiding the arena scratch + its two copies.
-        if (parallax_arena_contains(in) && parallax_arena_contains(out)) {
+        // (A separate `out` needs a host copy first, which a captured graph would not
+        // repeat: while capturing, that case stages, which aborts the capture.)
+        if (parallax_arena_contains(in) && parallax_arena_contains(out) &&
+            (in == out || !parallax_graph_capturing())) {
+            parallax_flush();
             if (in != out) std::memcpy(out, in, n * sizeof(T));
             parallax_scan(ks, ka, out, n, sizeof(T));
             return;
         }
         void* ab = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ab) {
+            parallax_flush();
             std::memcpy(ab, in, n * sizeof(T));
             parallax_scan(ks, ka, ab, n, sizeof(T));
+            parallax_flush();
             std::memcpy(out, ab, n * sizeof(T));
             parallax_arena_free(ab);
             return;
         }
     }
+    parallax_flush();
     T acc{};
     for (std::size_t i = 0; i < n; ++i) { acc = acc + in[i]; out[i] = acc; }
 }
@@ -226,14 +325,17 @@ __attribute__((noinline)) void device_exclusive_scan(const T* in, T* out, std::s
         void* as = parallax_arena_alloc(n * sizeof(T), alignof(T));  // scratch: inclusive scan
         void* ao = parallax_arena_alloc(n * sizeof(T), alignof(T));  // output
         if (as && ao) {
+            parallax_flush();
             std::memcpy(as, in, n * sizeof(T));
             parallax_exclusive_scan(ks, ka, kh, as, ao, n, sizeof(T), &init);
+            parallax_flush();
             std::memcpy(out, ao, n * sizeof(T));
             parallax_arena_free(ao);
             parallax_arena_free(as);
             return;
         }
     }
+    parallax_flush();
     T acc = init;
     for (std::size_t i = 0; i < n; ++i) { T t = in[i]; out[i] = acc; acc = acc + t; }
 }
@@ -252,6 +354,7 @@ __attribute__((noinline)) U device_transform_reduce(const T* in, std::size_t n,
         void* ai = parallax_arena_alloc(n * sizeof(T), alignof(T));
         void* ao = parallax_arena_alloc(n * sizeof(U), alignof(U));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, in, n * sizeof(T));
             parallax_kernel_launch_transform2(kx, ai, ao, n, sizeof(T), sizeof(U));
             U gpu{};
@@ -261,6 +364,7 @@ __attribute__((noinline)) U device_transform_reduce(const T* in, std::size_t n,
             return gpu;
         }
     }
+    parallax_flush();
     U acc{};
     for (std::size_t i = 0; i < n; ++i) acc = acc + static_cast<U>(f(in[i]));
     return acc;
@@ -278,6 +382,7 @@ __attribute__((noinline)) long device_count_if(const T* in, std::size_t n, Pred
         void* ai = parallax_arena_alloc(n * sizeof(T), alignof(T));
         void* ao = parallax_arena_alloc(n * sizeof(int), alignof(int));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, in, n * sizeof(T));
             parallax_kernel_launch_transform2(kp, ai, ao, n, sizeof(T), sizeof(int));
             int gpu = 0;
@@ -287,6 +392,7 @@ __attribute__((noinline)) long device_count_if(const T* in, std::size_t n, Pred
             return gpu;
         }
     }
+    parallax_flush();
     long c = 0;
     for (std::size_t i = 0; i < n; ++i) if (pred(in[i])) ++c;
     return c;
@@ -294,9 +400,11 @@ __attribute__((noinline)) long device_count_if(const T* in, std::size_t n, Pred
 
 // Compaction funnels (deterministic — so they offload in GENERIC wrappers, unlike the
 // concrete-only collector path). Each looks up four kernels (:flags/:scan/:add/:scatter)
-// and calls parallax_copy_if, which returns the kept count (num_true for partition).
+// and calls parallax_copy_if (parallax_partition for partition), which returns the kept
+// count (num_true for partition).
 // copy_if writes to a separate output; remove_if/unique/partition compact in place. Host
 // fallback on a MISS keeps ISO semantics. MVP: captureless predicate (std::is_empty_v).
+// copy_if issued asynchronously leaves its kept count in *(size_t*)current_async->result.
 template <class T, class Pred>
 __attribute__((noinline)) std::size_t device_copy_if(const T* in, T* out, std::size_t n, Pred pred) {
     static parallax_kernel_t kf = parallax_kernel_lookup((std::string(__PRETTY_FUNCTION__) + ":flags").c_str());
@@ -307,7 +415,20 @@ __attribute__((noinline)) std::size_t device_copy_if(const T* in, T* out, std::s
         void* ai = parallax_arena_alloc(n * sizeof(T), alignof(T));
         void* ao = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, in, n * sizeof(T));
+            if (async_issue* async = current_async) {
+                auto* kept = static_cast<std::size_t*>(async->result);
+                parallax_copy_if_async(async->stream, kf, ks, ka, kc, ai, ao, n, sizeof(T),
+                                       std::is_floating_point_v<T> ? 1 : 0, kept);
+                async->finish.push_back([out, ai, ao, kept] {
+                    std::memcpy(out, ao, *kept * sizeof(T));
+                    parallax_arena_free(ao);
+                    parallax_arena_free(ai);
+                });
+                async->pending = true;
+                return 0;
+            }
             std::size_t kept = parallax_copy_if(kf, ks, ka, kc, ai, ao, n, sizeof(T),
                                                 std::is_floating_point_v<T> ? 1 : 0);
             std::memcpy(out, ao, kept * sizeof(T));
@@ -316,6 +437,7 @@ __attribute__((noinline)) std::size_t device_copy_if(const T* in, T* out, std::s
             return kept;
         }
     }
+    parallax_flush();
     std::size_t k = 0;
     for (std::size_t i = 0; i < n; ++i) if (pred(in[i])) out[k++] = in[i];
     return k;
@@ -331,6 +453,7 @@ __attribute__((noinline)) std::size_t device_remove_if(T* data, std::size_t n, P
         void* ai = parallax_arena_alloc(n * sizeof(T), alignof(T));
         void* ao = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, data, n * sizeof(T));
             std::size_t kept = parallax_copy_if(kf, ks, ka, kc, ai, ao, n, sizeof(T),
                                                 std::is_floating_point_v<T> ? 1 : 0);
@@ -340,6 +463,7 @@ __attribute__((noinline)) std::size_t device_remove_if(T* data, std::size_t n, P
             return kept;
         }
     }
+    parallax_flush();
     std::size_t k = 0;
     for (std::size_t i = 0; i < n; ++i) if (!pred(data[i])) data[k++] = data[i];
     return k;
@@ -355,17 +479,19 @@ __attribute__((noinline)) std::size_t device_partition(T* data, std::size_t n, P
         void* ai = parallax_arena_alloc(n * sizeof(T), alignof(T));
         void* ao = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, data, n * sizeof(T));
             // The partition scatter writes EVERY element (kept to the front, rest after);
-            // parallax_copy_if returns num_true (the partition point).
-            std::size_t num_true = parallax_copy_if(kf, ks, ka, kc, ai, ao, n, sizeof(T),
-                                                    std::is_floating_point_v<T> ? 1 : 0);
+            // parallax_partition returns num_true (the partition point).
+            std::size_t num_true = parallax_partition(kf, ks, ka, kc, ai, ao, n, sizeof(T),
+                                                      std::is_floating_point_v<T> ? 1 : 0);
             std::memcpy(data, ao, n * sizeof(T));  // all n elements, reordered
             parallax_arena_free(ao);
             parallax_arena_free(ai);
             return num_true;
         }
     }
+    parallax_flush();
     T* mid = std::partition(data, data + n, pred);
     return static_cast<std::size_t>(mid - data);
 }
@@ -380,6 +506,7 @@ __attribute__((noinline)) std::size_t device_unique(T* data, std::size_t n) {
         void* ai = parallax_arena_alloc(n * sizeof(T), alignof(T));
         void* ao = parallax_arena_alloc(n * sizeof(T), alignof(T));
         if (ai && ao) {
+            parallax_flush();
             std::memcpy(ai, data, n * sizeof(T));
             std::size_t kept = parallax_copy_if(kf, ks, ka, kc, ai, ao, n, sizeof(T),
                                                 std::is_floating_point_v<T> ? 1 : 0);
@@ -389,6 +516,7 @@ __attribute__((noinline)) std::size_t device_unique(T* data, std::size_t n) {
             return kept;
         }
     }
+    parallax_flush();
     T* e = std::unique(data, data + n);
     return static_cast<std::size_t>(e - data);
 }
@@ -5,6 +5,7 @@
 #include <cstddef>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <cstdint>
 
@@ -103,6 +104,9 @@ private:
     VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
     
     std::unordered_map<void*, std::unique_ptr<UnifiedBuffer>> buffers_;
+    // Guards buffers_ (and each buffer's dirty tracking): launches on different host
+    // threads register and sync buffers concurrently.
+    std::mutex mutex_;
 };
 
 } // namespace parallax
@@ -2,6 +2,10 @@
 #define PARALLAX_VULKAN_BACKEND_HPP
 
 #include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <optional>
 #include <string>
@@ -10,6 +14,7 @@ namespace parallax {
 
 struct QueueFamilyIndices {
     std::optional<uint32_t> compute_family;
+    uint32_t compute_queue_count = 0;  // queues the compute family offers
 
     bool is_complete() const {
         return compute_family.has_value();
@@ -37,8 +42,37 @@ struct DeviceCapabilities {
     // buffer, so the whole captured heap is GPU-addressable with no copy (Phase 3).
     bool     external_memory_host = false;
     uint64_t min_imported_host_pointer_alignment = 4096;
+    // VK_KHR_push_descriptor: the launcher writes each dispatch's buffer bindings into
+    // the command buffer instead of allocating descriptor sets from a pool. Cleared
+    // when PARALLAX_NO_PUSH_DESCRIPTORS is set (forces the pooled fallback).
+    bool push_descriptor = false;
+    // Identity of the physical device (VkPhysicalDeviceIDProperties::deviceUUID): the
+    // workgroup tuner keys its on-disk cache by it.
+    uint8_t device_uuid[VK_UUID_SIZE] = {};
+    // GPU timestamps on the compute queue (the tuner times dispatches with them): valid
+    // bits of a timestamp (0 = unsupported) and nanoseconds per tick.
+    uint32_t timestamp_valid_bits = 0;
+    float    timestamp_period = 1.0f;
+    // Timeline semaphores (core in Vulkan 1.2): submissions to each compute queue are
+    // ordered and waited on through one counter per queue (see VulkanBackend::submit).
+    // Cleared when PARALLAX_NO_TIMELINE is set (forces per-submission fences and a
+    // single queue).
+    bool timeline_semaphore = false;
 };
 
+// How a host thread waits for a fence. Latency: poll the fence for a bounded time
+// (adapted to how long recent waits took) before blocking in the driver, so a short
+// kernel's completion is seen without a sleep/wake round trip. Efficiency: block at
+// once and leave the core to other work.
+enum class WaitMode { Latency, Efficiency };
+
+// Priority class of a host thread's launches. High is latency-critical request-path
+// work, Low is background batch work (large sorts), Normal everything else. Each class
+// has its own compute queue where the device offers enough of them (see
+// acquire_queue), and below High the launcher splits long primitives into bounded
+// submissions while High work is in flight, so the high-priority queue gets the device.
+enum class LaunchPriority { Low, Normal, High };
+
 class VulkanBackend {
 public:
     VulkanBackend();
@@ -56,13 +90,90 @@ public:
     VkInstance instance() const { return instance_; }
     VkPhysicalDevice physical_device() const { return physical_device_; }
     VkDevice device() const { return device_; }
-    VkQueue compute_queue() const { return compute_queue_; }
+    VkQueue compute_queue(uint32_t index = 0) const {
+        return index < queues_.size() ? queues_[index]->queue : VK_NULL_HANDLE;
+    }
     uint32_t compute_queue_family() const { return queue_indices_.compute_family.value(); }
+    // The compute family is a compute-only (async compute) one when the device has it,
+    // else the first with compute. All of its queues are created, up to
+    // kMaxComputeQueues and PARALLAX_QUEUES; a single one without a timeline
+    // semaphore, since the timelines are what order work across queues.
+    static constexpr uint32_t kMaxComputeQueues = 8;
+    uint32_t compute_queue_count() const { return static_cast<uint32_t>(queues_.size()); }
+    // vkQueueSubmit/vkQueueWaitIdle require external synchronization of a queue.
+    // submit() and wait_queue_idle() hold its lock for the call only; every submitter
+    // (kernel launcher threads, arena migrations) goes through them.
+    std::mutex& queue_mutex(uint32_t index = 0) { return queues_[index]->mutex; }
+    // Queue-selection policy: each launch context (one per host thread) takes the queue
+    // with the fewest users among those of its priority class and keeps it, so
+    // independent threads' work lands on different queues and can overlap, while one
+    // thread's submissions stay in order. With three queues or more the last is kept
+    // for High contexts, with four or more the one before it for Low ones, so Normal
+    // threads always have two queues to spread over; the queues are created with queue
+    // priorities 1.0 / 0.5 / 0.0 to match. A class without a queue of its own shares
+    // the Normal ones.
+    uint32_t acquire_queue(LaunchPriority priority = LaunchPriority::Normal);
+    void release_queue(uint32_t index);
+    uint32_t queue_users(uint32_t index) const { return queues_[index]->users.load(std::memory_order_relaxed); }
+    LaunchPriority queue_role(uint32_t index) const { return queues_[index]->role; }
+    // High-priority submissions between submit and retire: the launcher reports each
+    // one, and high_priority_active() says whether any is in flight.
+    void high_priority_submitted() { high_priority_work_.fetch_add(1, std::memory_order_relaxed); }
+    void high_priority_retired() { high_priority_work_.fetch_sub(1, std::memory_order_relaxed); }
+    bool high_priority_active() const { return high_priority_work_.load(std::memory_order_relaxed) > 0; }
     
     // Device info
     std::string device_name() const;
     uint32_t api_version() const;
     const DeviceCapabilities& capabilities() const { return capabilities_; }
+    const VkPhysicalDeviceLimits& limits() const { return device_properties_.limits; }
+    // vkCmdPushDescriptorSetKHR, or nullptr when push descriptors are unavailable.
+    PFN_vkCmdPushDescriptorSetKHR cmd_push_descriptor_set() const { return cmd_push_descriptor_set_; }
+
+    // Wait until `fence` is signaled, under the wait mode. In latency mode the fence is
+    // polled for up to twice the recent average wait (an exponential average of the
+    // waits that needed one), capped at kMaxSpinNs, then the thread blocks; a device
+    // whose waits run longer than the cap only gets kMinSpinNs of polling. Every
+    // waiter in the process (launcher frames, arena migrations) goes through here.
+    // The mode defaults to latency, or efficiency on a CPU implementation (a polling
+    // thread takes a core from the device); PARALLAX_WAIT=latency|efficiency
+    // overrides it, and set_wait_mode() changes it at any time.
+    static constexpr uint64_t kMaxSpinNs = 100000;
+    static constexpr uint64_t kMinSpinNs = 2000;
+    VkResult wait_fence(VkFence fence);
+    void set_wait_mode(WaitMode mode) { wait_mode_.store(mode, std::memory_order_relaxed); }
+    WaitMode wait_mode() const { return wait_mode_.load(std::memory_order_relaxed); }
+    // Polling budget of the next latency-mode wait.
+    uint64_t spin_budget_ns() const;
+
+    // Submit `cmd` to compute queue `queue` (takes that queue's lock). With timeline
+    // semaphores every submission waits device-side for the one before it on its
+    // queue (whichever thread or component made it), and for the newest value the
+    // host has seen reached on each other queue (already signaled, so no stall: it
+    // makes that work's writes visible to this submission), then signals the next
+    // value of its queue's timeline, returned in *value. Completion of a submission is
+    // "timeline >= value", and waiting for the newest value waits for everything
+    // before it on the queue. `after_all` waits for everything submitted to every
+    // queue instead (arena migrations read or overwrite the whole arena). Without
+    // timelines, *value is 0 and `fence` (may be VK_NULL_HANDLE with one) is the only
+    // completion signal. A failed submit consumes no value.
+    VkResult submit(uint32_t queue, VkCommandBuffer cmd, VkFence fence, uint64_t* value,
+                    bool after_all = false);
+    // A compute queue's timeline, or VK_NULL_HANDLE when the device has none.
+    VkSemaphore timeline(uint32_t queue = 0) const {
+        return queue < queues_.size() ? queues_[queue]->timeline : VK_NULL_HANDLE;
+    }
+    // Last timeline value submit() handed out on `queue`.
+    uint64_t timeline_submitted(uint32_t queue) const {
+        return queues_[queue]->submitted.load(std::memory_order_acquire);
+    }
+    // Whether `queue`'s timeline has reached `value` (never blocks).
+    bool timeline_reached(uint32_t queue, uint64_t value);
+    // Wait, under the wait mode, until `queue`'s timeline reaches `value`.
+    VkResult wait_timeline(uint32_t queue, uint64_t value);
+    // Wait for everything submitted to every compute queue so far: timeline waits that
+    // leave the queues to other submitters, else vkQueueWaitIdle under the queue lock.
+    void wait_queue_idle();
 
 private:
     bool create_instance();
@@ -72,15 +183,35 @@ private:
 
     QueueFamilyIndices find_queue_families(VkPhysicalDevice device);
     bool is_device_suitable(VkPhysicalDevice device);
+    // Poll `poll` (VK_NOT_READY until done) under the wait mode, then `block`.
+    template <typename Poll, typename Block>
+    VkResult wait_polled(Poll poll, Block block);
+    // Record that the host has seen `queue`'s timeline reach `value`.
+    void note_reached(uint32_t queue, uint64_t value);
+
+    struct ComputeQueue {
+        VkQueue queue = VK_NULL_HANDLE;
+        std::mutex mutex;
+        VkSemaphore timeline = VK_NULL_HANDLE;
+        std::atomic<uint64_t> submitted{0};  // written under `mutex`
+        std::atomic<uint64_t> reached{0};    // newest value the host has seen reached
+        std::atomic<uint32_t> users{0};      // launch contexts using the queue
+        LaunchPriority role = LaunchPriority::Normal;
+    };
     
     VkInstance instance_ = VK_NULL_HANDLE;
     VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
     VkDevice device_ = VK_NULL_HANDLE;
-    VkQueue compute_queue_ = VK_NULL_HANDLE;
+    std::vector<std::unique_ptr<ComputeQueue>> queues_;
+    std::mutex queue_select_mutex_;
+    std::atomic<uint32_t> high_priority_work_{0};
     
     QueueFamilyIndices queue_indices_;
     VkPhysicalDeviceProperties device_properties_;
     DeviceCapabilities capabilities_;
+    PFN_vkCmdPushDescriptorSetKHR cmd_push_descriptor_set_ = nullptr;
+    std::atomic<WaitMode> wait_mode_{WaitMode::Latency};
+    std::atomic<uint64_t> wait_average_ns_{0};  // of waits that found the fence unsignaled
 
     // True only when the validation layer is actually present at runtime. Built
     // with PARALLAX_ENABLE_VALIDATION we *request* validation, but if the layer
@@ -0,0 +1,98 @@
+#pragma once
+
+// WorkgroupTuner — picks the workgroup size of a specializable kernel per device.
+//
+// Library and generated kernels that size their workgroup through a specialization
+// constant (local_size_x_id) are built once per candidate size (see
+// KernelLauncher::load_kernel). The best size depends on the device far more than on
+// the kernel: lavapipe runs a workgroup on a CPU thread and prefers large ones, a GPU
+// prefers whatever fills its SIMD units without starving occupancy. So the tuner times
+// the candidates on the real launches themselves: the first launches of a kernel in a
+// problem-size bucket rotate through the candidate sizes (each still computes the
+// right result), GPU timestamps measure them, and once every candidate has
+// kSamplesPerSize timings the fastest becomes that bucket's size (a candidate the
+// bucket's launches stop offering is dropped rather than waited for). Winners are written
+// to a small text file named after the device UUID, so later runs on the same device
+// start tuned. Processes sharing the file merge their winners into it.
+//
+// Kernels are identified by a hash of their SPIR-V (stable across runs, unlike handle
+// addresses). Thread-safe: launches on any thread choose and report concurrently.
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace parallax {
+
+class WorkgroupTuner {
+public:
+    // Timed launches per candidate size before a bucket's winner is chosen.
+    static constexpr uint32_t kSamplesPerSize = 3;
+
+    // Loads the winners cached for `device_uuid`. The cache lives in
+    // $PARALLAX_CACHE_DIR, else $XDG_CACHE_HOME/parallax, else ~/.cache/parallax;
+    // with none of those set, winners are kept in memory only.
+    explicit WorkgroupTuner(const uint8_t (&device_uuid)[VK_UUID_SIZE]);
+
+    WorkgroupTuner(const WorkgroupTuner&) = delete;
+    WorkgroupTuner& operator=(const WorkgroupTuner&) = delete;
+
+    // Problem-size bucket of a dispatch over `count` elements: counts within a
+    // factor of four share one.
+    static uint32_t bucket_of(size_t count);
+
+    // Workgroup size for the next launch of `kernel` in `bucket`, out of `sizes`
+    // (ascending, non-empty). Returns the bucket's winner once there is one. While
+    // the bucket is still being tuned, returns the candidate with the fewest timings
+    // issued and sets *sample: the caller times that launch and reports it with
+    // record() (or cancel() when it cannot). Otherwise, or when `sample` is null (a
+    // launch that cannot be timed), returns `fallback`.
+    uint32_t choose(uint64_t kernel, uint32_t bucket, const std::vector<uint32_t>& sizes,
+                    uint32_t fallback, bool* sample);
+    // A timed launch of `size` took `ns` nanoseconds of GPU time.
+    void record(uint64_t kernel, uint32_t bucket, uint32_t size, uint64_t ns);
+    // A launch choose() asked to time was not timed after all.
+    void cancel(uint64_t kernel, uint32_t bucket, uint32_t size);
+    // Whether `bucket` of `kernel` has a winner (its launches are no longer sampled).
+    bool tuned(uint64_t kernel, uint32_t bucket);
+
+    const std::string& cache_path() const { return path_; }
+
+private:
+    struct Trial {
+        uint32_t size = 0;
+        uint32_t issued = 0;   // timings handed out by choose()
+        uint32_t done = 0;     // timings reported back
+        uint64_t best_ns = UINT64_MAX;
+    };
+    struct Entry {
+        uint32_t winner = 0;   // 0 while tuning
+        std::vector<Trial> trials;
+    };
+    using Key = std::pair<uint64_t, uint32_t>;  // kernel hash, size bucket
+    Trial* find_trial(uint64_t kernel, uint32_t bucket, uint32_t size);  // mutex_ held
+    // Make the fastest trial the winner once every trial has its timings; true when
+    // this call did.
+    bool pick_winner(uint64_t kernel, uint32_t bucket, Entry& entry);  // mutex_ held
+    std::map<Key, uint32_t> snapshot() const;  // mutex_ held: every winner so far
+    // The winners in the cache file (none without one).
+    std::map<Key, uint32_t> read_cache() const;
+    // Adopt the winners in the cache file for every bucket not tuned here yet.
+    void load();  // in the constructor
+    // Under the cache's lock file: merge the file's winners into `winners` (a snapshot,
+    // whose entries take precedence) and adopt them here, then rewrite the file with
+    // all of them. Called without mutex_, which it takes only to adopt.
+    void save(std::map<Key, uint32_t> winners);
+
+    std::map<Key, Entry> entries_;
+    std::mutex mutex_;
+    std::string path_;
+};
+
+}  // namespace parallax
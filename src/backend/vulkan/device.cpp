@@ -1,5 +1,8 @@
 #include "parallax/vulkan_backend.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
 #include <set>
 
@@ -33,17 +36,30 @@ bool VulkanBackend::initialize() {
     // is created, so features (e.g. bufferDeviceAddress) can be enabled.
     detect_capabilities();
 
+    // Fence waits poll before blocking (see wait_fence), except on a CPU implementation.
+    if (device_properties_.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) wait_mode_ = WaitMode::Efficiency;
+    if (const char* mode = std::getenv("PARALLAX_WAIT")) {
+        if (std::strcmp(mode, "latency") == 0) wait_mode_ = WaitMode::Latency;
+        else if (std::strcmp(mode, "efficiency") == 0) wait_mode_ = WaitMode::Efficiency;
+        else std::cerr << "PARALLAX_WAIT: unknown mode '" << mode << "' (latency or efficiency)" << std::endl;
+    }
+
     if (!create_logical_device()) {
         std::cerr << "Failed to create logical device" << std::endl;
         return false;
     }
     
-    std::cout << "Parallax initialized on: " << device_name() << std::endl;
+    std::cout << "Parallax initialized on: " << device_name() << " (" << compute_queue_count()
+              << " compute queue" << (compute_queue_count() == 1 ? "" : "s") << ", fence waits: "
+              << (wait_mode() == WaitMode::Latency ? "latency" : "efficiency") << ")" << std::endl;
     return true;
 }
 
 void VulkanBackend::cleanup() {
     if (device_ != VK_NULL_HANDLE) {
+        for (auto& queue : queues_)
+            if (queue->timeline != VK_NULL_HANDLE) vkDestroySemaphore(device_, queue->timeline, nullptr);
+        queues_.clear();
         vkDestroyDevice(device_, nullptr);
         device_ = VK_NULL_HANDLE;
     }
@@ -175,13 +191,17 @@ QueueFamilyIndices VulkanBackend::find_queue_families(VkPhysicalDevice device) {
     std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_count, queue_families.data());
     
-    int i = 0;
-    for (const auto& queue_family : queue_families) {
-        if (queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) {
+    // Prefer a compute-only family (the async compute queues of a discrete GPU, which
+    // run beside graphics work), else the first family with compute.
+    for (uint32_t i = 0; i < queue_family_count; ++i) {
+        const VkQueueFlags flags = queue_families[i].queueFlags;
+        if (!(flags & VK_QUEUE_COMPUTE_BIT)) continue;
+        const bool compute_only = !(flags & VK_QUEUE_GRAPHICS_BIT);
+        if (!indices.compute_family || compute_only) {
             indices.compute_family = i;
-            break;
+            indices.compute_queue_count = queue_families[i].queueCount;
+            if (compute_only) break;
         }
-        i++;
     }
     
     return indices;
@@ -191,10 +211,30 @@ bool VulkanBackend::create_logical_device() {
     VkDeviceQueueCreateInfo queue_create_info{};
     queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
     queue_create_info.queueFamilyIndex = queue_indices_.compute_family.value();
-    queue_create_info.queueCount = 1;
+    // Every queue of the family (see compute_queue_count), each at its role's priority
+    // (see role_of below).
+    uint32_t queue_count = capabilities_.timeline_semaphore
+                               ? std::min(std::max(queue_indices_.compute_queue_count, 1u), kMaxComputeQueues)
+                               : 1;
+    if (const char* cap = std::getenv("PARALLAX_QUEUES")) {
+        const long n = std::strtol(cap, nullptr, 10);
+        if (n >= 1) queue_count = std::min(queue_count, static_cast<uint32_t>(n));
+    }
+    queue_create_info.queueCount = queue_count;
     
-    float queue_priority = 1.0f;
-    queue_create_info.pQueuePriorities = &queue_priority;
+    // Queue roles (see acquire_queue): the last queue for High work once there are three,
+    // the one before it for Low work once there are four, so Normal keeps two queues.
+    auto role_of = [queue_count](uint32_t i) {
+        if (queue_count >= 3 && i == queue_count - 1) return LaunchPriority::High;
+        if (queue_count >= 4 && i == queue_count - 2) return LaunchPriority::Low;
+        return LaunchPriority::Normal;
+    };
+    std::vector<float> queue_priorities(queue_count);
+    for (uint32_t i = 0; i < queue_count; ++i) {
+        const LaunchPriority role = role_of(i);
+        queue_priorities[i] = role == LaunchPriority::High ? 1.0f : role == LaunchPriority::Low ? 0.0f : 0.5f;
+    }
+    queue_create_info.pQueuePriorities = queue_priorities.data();
     
     VkPhysicalDeviceVulkan11Features vulkan11_features{};
     vulkan11_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
@@ -221,10 +261,17 @@ bool VulkanBackend::create_logical_device() {
     VkPhysicalDevice16BitStorageFeatures s16_en{};
     s16_en.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
     s16_en.storageBuffer16BitAccess = capabilities_.storage_buffer_16bit ? VK_TRUE : VK_FALSE;
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_en{};
+    timeline_en.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timeline_en.timelineSemaphore = VK_TRUE;
     vulkan11_features.pNext = &f16i8_en;
     f16i8_en.pNext = &s8_en;
     s8_en.pNext = &s16_en;
     s16_en.pNext = capabilities_.buffer_device_address ? static_cast<void*>(&bda_features) : nullptr;
+    if (capabilities_.timeline_semaphore) {  // -> [timeline] at the head of the chain
+        timeline_en.pNext = vulkan11_features.pNext;
+        vulkan11_features.pNext = &timeline_en;
+    }
 
     VkPhysicalDeviceFeatures device_features{};
     device_features.shaderInt64 = capabilities_.shader_int64 ? VK_TRUE : VK_FALSE;
@@ -239,6 +286,8 @@ bool VulkanBackend::create_logical_device() {
     // Whole-heap import (Phase 3): the arena adopts the heap pool as a device buffer.
     if (capabilities_.external_memory_host)
         device_extensions.push_back("VK_EXT_external_memory_host");
+    if (capabilities_.push_descriptor)
+        device_extensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
     
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -265,10 +314,201 @@ bool VulkanBackend::create_logical_device() {
         return false;
     }
     
-    vkGetDeviceQueue(device_, queue_indices_.compute_family.value(), 0, &compute_queue_);
+    for (uint32_t i = 0; i < queue_count; ++i) {
+        queues_.push_back(std::make_unique<ComputeQueue>());
+        vkGetDeviceQueue(device_, queue_indices_.compute_family.value(), i, &queues_.back()->queue);
+        queues_.back()->role = role_of(i);
+    }
+
+    // Extension commands are not exported by the loader; fetch the push-descriptor entry
+    // point and fall back to pooled descriptor sets if the driver does not provide it.
+    if (capabilities_.push_descriptor) {
+        cmd_push_descriptor_set_ = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+            vkGetDeviceProcAddr(device_, "vkCmdPushDescriptorSetKHR"));
+        capabilities_.push_descriptor = cmd_push_descriptor_set_ != nullptr;
+    }
+
+    // One timeline per queue; without them, submissions fall back to fences on the
+    // first queue alone (nothing would order work across queues).
+    if (capabilities_.timeline_semaphore) {
+        VkSemaphoreTypeCreateInfo type_info{};
+        type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        type_info.initialValue = 0;
+        VkSemaphoreCreateInfo semaphore_info{};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphore_info.pNext = &type_info;
+        for (auto& queue : queues_) {
+            if (vkCreateSemaphore(device_, &semaphore_info, nullptr, &queue->timeline) == VK_SUCCESS) continue;
+            std::cerr << "[Parallax] timeline semaphore creation failed; using fences" << std::endl;
+            for (auto& created : queues_) {
+                if (created->timeline != VK_NULL_HANDLE) vkDestroySemaphore(device_, created->timeline, nullptr);
+                created->timeline = VK_NULL_HANDLE;
+            }
+            capabilities_.timeline_semaphore = false;
+            queues_.resize(1);
+            queues_[0]->role = LaunchPriority::Normal;
+            break;
+        }
+    }
     return true;
 }
 
+uint64_t VulkanBackend::spin_budget_ns() const {
+    const uint64_t average = wait_average_ns_.load(std::memory_order_relaxed);
+    if (average > kMaxSpinNs) return kMinSpinNs;  // long waits: blocking costs little extra
+    return std::min(kMaxSpinNs, 2 * average + kMinSpinNs);
+}
+
+template <typename Poll, typename Block>
+VkResult VulkanBackend::wait_polled(Poll poll, Block block) {
+    VkResult status = poll();
+    if (status != VK_NOT_READY) return status;  // signaled (or lost): nothing to wait for
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    auto elapsed_ns = [&] {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+    };
+    if (wait_mode() == WaitMode::Latency) {
+        const uint64_t budget = spin_budget_ns();
+        while ((status = poll()) == VK_NOT_READY && elapsed_ns() < budget) {
+        }
+    }
+    if (status == VK_NOT_READY) status = block();
+
+    // Exponential average (1/8 weight) of how long waits take; concurrent waiters may
+    // drop an update, which only slows the adaptation.
+    const uint64_t sample = elapsed_ns();
+    const uint64_t average = wait_average_ns_.load(std::memory_order_relaxed);
+    wait_average_ns_.store(average - average / 8 + sample / 8, std::memory_order_relaxed);
+    return status;
+}
+
+VkResult VulkanBackend::wait_fence(VkFence fence) {
+    return wait_polled([&] { return vkGetFenceStatus(device_, fence); },
+                       [&] { return vkWaitForFences(device_, 1, &fence, VK_TRUE, UINT64_MAX); });
+}
+
+uint32_t VulkanBackend::acquire_queue(LaunchPriority priority) {
+    std::lock_guard<std::mutex> lock(queue_select_mutex_);
+    bool own = false;  // the class has a queue of its own
+    for (const auto& queue : queues_) own |= queue->role == priority;
+    const LaunchPriority role = own ? priority : LaunchPriority::Normal;
+    uint32_t best = 0;
+    bool found = false;
+    for (uint32_t i = 0; i < queues_.size(); ++i) {
+        if (queues_[i]->role != role) continue;
+        if (!found || queues_[i]->users.load(std::memory_order_relaxed) <
+                          queues_[best]->users.load(std::memory_order_relaxed))
+            best = i;
+        found = true;
+    }
+    queues_[best]->users.fetch_add(1, std::memory_order_relaxed);
+    return best;
+}
+
+void VulkanBackend::release_queue(uint32_t index) {
+    std::lock_guard<std::mutex> lock(queue_select_mutex_);
+    if (index < queues_.size() && queues_[index]->users.load(std::memory_order_relaxed) > 0)
+        queues_[index]->users.fetch_sub(1, std::memory_order_relaxed);
+}
+
+VkResult VulkanBackend::submit(uint32_t queue, VkCommandBuffer cmd, VkFence fence, uint64_t* value,
+                               bool after_all) {
+    ComputeQueue& q = *queues_[queue];
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &cmd;
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.timeline == VK_NULL_HANDLE) {
+        *value = 0;
+        return vkQueueSubmit(q.queue, 1, &submit_info, fence);
+    }
+    // Wait for the queue's previous value (ordering this submission's shader and
+    // transfer accesses after everything earlier on it) and for the other queues' work
+    // (seen complete, or all of it with after_all), then signal the next value.
+    VkSemaphore wait_semaphores[kMaxComputeQueues];
+    uint64_t wait_values[kMaxComputeQueues];
+    VkPipelineStageFlags wait_stages[kMaxComputeQueues];
+    uint32_t waits = 0;
+    for (uint32_t i = 0; i < queues_.size(); ++i) {
+        const ComputeQueue& other = *queues_[i];
+        const uint64_t wait_value = (i == queue || after_all) ? other.submitted.load(std::memory_order_acquire)
+                                                              : other.reached.load(std::memory_order_acquire);
+        if (wait_value == 0) continue;
+        wait_semaphores[waits] = other.timeline;
+        wait_values[waits] = wait_value;
+        wait_stages[waits] = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        ++waits;
+    }
+    const uint64_t next = q.submitted.load(std::memory_order_relaxed) + 1;
+    VkTimelineSemaphoreSubmitInfo timeline_info{};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = waits;
+    timeline_info.pWaitSemaphoreValues = wait_values;
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &next;
+    submit_info.pNext = &timeline_info;
+    submit_info.waitSemaphoreCount = waits;
+    submit_info.pWaitSemaphores = wait_semaphores;
+    submit_info.pWaitDstStageMask = wait_stages;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &q.timeline;
+    const VkResult result = vkQueueSubmit(q.queue, 1, &submit_info, fence);
+    if (result != VK_SUCCESS) {
+        *value = 0;
+        return result;
+    }
+    q.submitted.store(next, std::memory_order_release);
+    *value = next;
+    return result;
+}
+
+void VulkanBackend::note_reached(uint32_t queue, uint64_t value) {
+    std::atomic<uint64_t>& reached = queues_[queue]->reached;
+    uint64_t seen = reached.load(std::memory_order_relaxed);
+    while (seen < value && !reached.compare_exchange_weak(seen, value, std::memory_order_release)) {
+    }
+}
+
+bool VulkanBackend::timeline_reached(uint32_t queue, uint64_t value) {
+    uint64_t counter = 0;
+    if (vkGetSemaphoreCounterValue(device_, queues_[queue]->timeline, &counter) != VK_SUCCESS) return false;
+    note_reached(queue, counter);
+    return counter >= value;
+}
+
+VkResult VulkanBackend::wait_timeline(uint32_t queue, uint64_t value) {
+    VkSemaphore timeline = queues_[queue]->timeline;
+    VkSemaphoreWaitInfo wait_info{};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &timeline;
+    wait_info.pValues = &value;
+    const VkResult result = wait_polled(
+        [&] {
+            uint64_t counter = 0;
+            const VkResult status = vkGetSemaphoreCounterValue(device_, timeline, &counter);
+            if (status != VK_SUCCESS) return status;
+            return counter >= value ? VK_SUCCESS : VK_NOT_READY;
+        },
+        [&] { return vkWaitSemaphores(device_, &wait_info, UINT64_MAX); });
+    if (result == VK_SUCCESS) note_reached(queue, value);
+    return result;
+}
+
+void VulkanBackend::wait_queue_idle() {
+    if (timeline() != VK_NULL_HANDLE) {
+        for (uint32_t i = 0; i < queues_.size(); ++i) wait_timeline(i, timeline_submitted(i));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(queues_[0]->mutex);
+    vkQueueWaitIdle(queues_[0]->queue);
+}
+
 std::string VulkanBackend::device_name() const {
     return std::string(device_properties_.deviceName);
 }
@@ -295,10 +535,16 @@ void VulkanBackend::detect_capabilities() {
     VkPhysicalDevice16BitStorageFeatures s16{};
     s16.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES;
     bda.pNext = &f16i8; f16i8.pNext = &s8; s8.pNext = &s16;
+    // Timeline semaphores: queried (and later enabled) only on a 1.2 device, where
+    // the feature struct is core.
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline{};
+    timeline.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    if (device_properties_.apiVersion >= VK_API_VERSION_1_2) s16.pNext = &timeline;
     VkPhysicalDeviceFeatures2 f2{};
     f2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     f2.pNext = &bda;
     vkGetPhysicalDeviceFeatures2(physical_device_, &f2);
+    capabilities_.timeline_semaphore = timeline.timelineSemaphore == VK_TRUE && !std::getenv("PARALLAX_NO_TIMELINE");
     capabilities_.buffer_device_address = bda.bufferDeviceAddress == VK_TRUE;
     capabilities_.shader_int8 = f16i8.shaderInt8 == VK_TRUE;
     capabilities_.shader_float16 = f16i8.shaderFloat16 == VK_TRUE;
@@ -317,11 +563,12 @@ void VulkanBackend::detect_capabilities() {
     std::vector<VkExtensionProperties> exts(ext_count);
     vkEnumerateDeviceExtensionProperties(physical_device_, nullptr, &ext_count, exts.data());
     for (const auto& e : exts) {
-        if (std::string(e.extensionName) == "VK_EXT_external_memory_host") {
+        if (std::string(e.extensionName) == "VK_EXT_external_memory_host")
             capabilities_.external_memory_host = true;
-            break;
-        }
+        else if (std::string(e.extensionName) == VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)
+            capabilities_.push_descriptor = true;
     }
+    if (std::getenv("PARALLAX_NO_PUSH_DESCRIPTORS")) capabilities_.push_descriptor = false;
     if (capabilities_.external_memory_host) {
         VkPhysicalDeviceExternalMemoryHostPropertiesEXT emh{};
         emh.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
@@ -333,12 +580,30 @@ void VulkanBackend::detect_capabilities() {
             emh.minImportedHostPointerAlignment ? emh.minImportedHostPointerAlignment : 4096;
     }
 
+    // Device UUID (core since 1.1) and compute-queue timestamp support.
+    VkPhysicalDeviceIDProperties id_props{};
+    id_props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+    VkPhysicalDeviceProperties2 props2{};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    props2.pNext = &id_props;
+    vkGetPhysicalDeviceProperties2(physical_device_, &props2);
+    std::memcpy(capabilities_.device_uuid, id_props.deviceUUID, VK_UUID_SIZE);
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &family_count, nullptr);
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &family_count, families.data());
+    if (queue_indices_.compute_family && *queue_indices_.compute_family < family_count)
+        capabilities_.timestamp_valid_bits = families[*queue_indices_.compute_family].timestampValidBits;
+    capabilities_.timestamp_period = props2.properties.limits.timestampPeriod;
+
     VkPhysicalDeviceProperties devprops;
     vkGetPhysicalDeviceProperties(physical_device_, &devprops);
     std::cout << "[Parallax] Device capabilities: int64=" << capabilities_.shader_int64
               << " float64=" << capabilities_.shader_float64
               << " buffer_device_address=" << capabilities_.buffer_device_address
               << " external_memory_host=" << capabilities_.external_memory_host
+              << " push_descriptor=" << capabilities_.push_descriptor
+              << " timeline_semaphore=" << capabilities_.timeline_semaphore
               << " (import_align=" << capabilities_.min_imported_host_pointer_alignment
               << ") minSSBOoffsetAlign=" << devprops.limits.minStorageBufferOffsetAlignment
               << std::endl;
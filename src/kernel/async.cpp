@@ -0,0 +1,190 @@
+#include "parallax/async.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallax::async::detail {
+
+namespace {
+
+// Sleep between polls of the in-flight events. Short next to any launch worth awaiting,
+// long enough that the thread does not hold a core while kernels run.
+constexpr auto kPollInterval = std::chrono::microseconds(50);
+
+// Runs resumed coroutines that have no executor of their own, so code resumed there
+// neither holds up the completion thread nor waits behind another coroutine. One per
+// process, created before the completion thread (and so destroyed after it).
+class ResumePool {
+public:
+    ResumePool() {
+        const unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < n; ++i) workers_.emplace_back([this] { run(); });
+    }
+
+    // Resumes what is queued before returning.
+    ~ResumePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(handle);
+        }
+        wake_.notify_one();
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+                if (ready_.empty()) return;
+                handle = ready_.front();
+                ready_.pop_front();
+            }
+            handle.resume();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::coroutine_handle<>> ready_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+ResumePool& resume_pool() {
+    static ResumePool pool;
+    return pool;
+}
+
+// Issues awaited algorithms on its own streams and resumes their coroutines as they
+// complete. One per process, started by the first submit().
+class CompletionThread {
+public:
+    CompletionThread() : thread_([this] { run(); }) {}
+
+    // Drains what is queued and in flight (resuming those coroutines) before returning.
+    ~CompletionThread() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+    void submit(operation* op) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_.push_back(op);
+        }
+        wake_.notify_one();
+    }
+
+private:
+    struct InFlight {
+        operation* op = nullptr;
+        parallax_stream_t stream = nullptr;
+        parallax_event_t event = nullptr;
+        parallax::detail::async_issue issue;
+    };
+
+    static InFlight issue(operation* op) {
+        InFlight f;
+        f.op = op;
+        f.stream = parallax_stream_create();
+        f.event = parallax_event_create();
+        f.issue.stream = f.stream;
+        try {
+            op->issue(f.issue);
+        } catch (...) {
+            op->error = std::current_exception();
+        }
+        parallax_event_record(f.event, f.stream);
+        return f;
+    }
+
+    // The work of `f` has completed: finish its host side and resume the coroutine.
+    static void retire(InFlight& f) {
+        operation* op = f.op;
+        try {
+            for (auto& finish : f.issue.finish) finish();  // also after a failed issue: frees scratch
+            if (!op->error) op->complete();
+        } catch (...) {
+            if (!op->error) op->error = std::current_exception();
+        }
+        parallax_event_destroy(f.event);
+        parallax_stream_destroy(f.stream);
+        // The coroutine may finish and free `op` while resuming; take what is needed first.
+        std::coroutine_handle<> handle = op->handle;
+        executor resume_on = std::move(op->resume_on);
+        const bool resume_inline = op->resume_inline;
+        try {
+            if (resume_on) resume_on(handle);
+            else if (resume_inline) handle.resume();
+            else resume_pool().post(handle);
+        } catch (const std::exception& e) {
+            std::cerr << "[parallax::async] exception escaped a resumed coroutine: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "[parallax::async] exception escaped a resumed coroutine" << std::endl;
+        }
+    }
+
+    void run() {
+        std::vector<InFlight> in_flight;
+        for (;;) {
+            std::vector<operation*> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                auto ready = [&] { return stopping_ || !queued_.empty(); };
+                if (in_flight.empty()) wake_.wait(lock, ready);
+                else wake_.wait_for(lock, kPollInterval, ready);
+                if (stopping_ && queued_.empty() && in_flight.empty()) return;
+                batch.swap(queued_);
+            }
+            for (operation* op : batch) in_flight.push_back(issue(op));
+            // Retire whatever has completed, in any order; a coroutine resumed inline may
+            // submit more (queued above, issued on the next pass).
+            for (size_t i = 0; i < in_flight.size();) {
+                if (!parallax_event_query(in_flight[i].event)) {
+                    ++i;
+                    continue;
+                }
+                InFlight done = std::move(in_flight[i]);
+                in_flight.erase(in_flight.begin() + static_cast<std::ptrdiff_t>(i));
+                retire(done);
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<operation*> queued_;
+    bool stopping_ = false;
+    std::thread thread_;  // last: starts once the members above exist
+};
+
+}  // namespace
+
+void submit(operation* op) {
+    resume_pool();  // constructed first, so it outlives the completion thread
+    static CompletionThread completion;
+    completion.submit(op);
+}
+
+}  // namespace parallax::async::detail
@@ -7,19 +7,29 @@
 #include <cstdlib>
 #include <iostream>
 #include <atomic>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace {
     // Global kernel launcher instance
     static std::unique_ptr<parallax::KernelLauncher> g_kernel_launcher;
     static std::atomic<uint64_t> g_kernel_counter{0};
 
-    // Kernel handle is just a heap-allocated string containing the kernel name
+    // Kernel handle: points straight at the loaded pipeline, so a launch never looks
+    // the kernel up by name. Handles are never freed (funnels cache them in statics).
     struct KernelHandle {
-        std::string name;
+        parallax::PipelineHandle pipeline;
     };
 
+    // Guards creation of g_kernel_launcher. The launcher itself is thread-safe; the
+    // entry points below read g_kernel_launcher without the lock because a caller
+    // can only hold a kernel handle after parallax_kernel_load (which took it) ran.
+    std::mutex g_launcher_init_mutex;
+
     bool ensure_kernel_launcher_initialized() {
+        std::lock_guard<std::mutex> lock(g_launcher_init_mutex);
         if (g_kernel_launcher) return true;
 
         auto* backend = parallax::get_global_backend();
@@ -34,9 +44,42 @@ namespace {
         std::cout << "[Parallax] KernelLauncher initialized" << std::endl;
         return true;
     }
+
+    // PARALLAX_LAZY=1: launches that hand nothing back to the host (element-wise maps,
+    // transforms, scans, sorts) are deferred -- recorded into the calling thread's open
+    // command buffer rather than submitted and waited on one by one. The next call that
+    // needs a result (a reduction, a compaction count, parallax_flush, a stream or graph
+    // operation) submits the whole queue at once.
+    bool lazy_enabled() {
+        static const bool lazy = std::getenv("PARALLAX_LAZY") != nullptr;
+        return lazy;
+    }
+
+    template <class F>
+    bool run_deferred(F&& fn) {
+        if (!lazy_enabled()) return fn();
+        g_kernel_launcher->set_deferred(true);
+        const bool ok = fn();
+        g_kernel_launcher->set_deferred(false);
+        return ok;
+    }
+
+    // Host sync-back of a registered (non-arena) buffer once the launch completed:
+    // right away for a waited launch, at the flush for a deferred one.
+    void sync_after_completion(void* buffer) {
+        auto* memory_manager = parallax::get_global_memory_manager();
+        if (memory_manager)
+            g_kernel_launcher->when_complete([memory_manager, buffer] {
+                memory_manager->sync_after_kernel(buffer);
+            });
+    }
 }
 
 parallax_kernel_t parallax_kernel_load(const unsigned int* spirv, size_t words) {
+    return parallax_kernel_load_flags(spirv, words, 0);
+}
+
+parallax_kernel_t parallax_kernel_load_flags(const unsigned int* spirv, size_t words, unsigned flags) {
     if (!ensure_kernel_launcher_initialized()) {
         std::cerr << "[parallax_kernel_load] Failed to initialize launcher" << std::endl;
         return nullptr;
@@ -46,20 +89,24 @@ parallax_kernel_t parallax_kernel_load(const unsigned int* spirv, size_t words)
     uint64_t id = g_kernel_counter.fetch_add(1);
     std::string kernel_name = "kernel_" + std::to_string(id);
 
-    std::cout << "[parallax_kernel_load] Loading kernel: " << kernel_name
-              << " (" << words << " SPIR-V words)" << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_load] Loading kernel: " << kernel_name
+                  << " (" << words << " SPIR-V words)" << std::endl;
 
     // Load kernel (size in bytes = words * 4)
-    bool success = g_kernel_launcher->load_kernel(kernel_name, spirv, words * 4);
+    static_assert(PARALLAX_KERNEL_INLINE_CAPTURES == parallax::KernelLauncher::kInlineCaptures,
+                  "C and C++ load flags must agree");
+    parallax::PipelineHandle pipeline = g_kernel_launcher->load_kernel(kernel_name, spirv, words * 4, flags);
 
-    if (!success) {
+    if (!pipeline) {
         std::cerr << "[parallax_kernel_load] Failed to load kernel" << std::endl;
         return nullptr;
     }
 
     // Create handle
-    auto* handle = new KernelHandle{kernel_name};
-    std::cout << "[parallax_kernel_load] Successfully loaded kernel: " << kernel_name << std::endl;
+    auto* handle = new KernelHandle{std::move(pipeline)};
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_load] Successfully loaded kernel: " << kernel_name << std::endl;
     return reinterpret_cast<parallax_kernel_t>(handle);
 }
 
@@ -71,6 +118,7 @@ namespace {
     struct FunnelEntry {
         const unsigned int* spirv;
         size_t words;
+        unsigned flags;  // PARALLAX_KERNEL_* metadata, passed to the load
         parallax_kernel_t handle;
         bool loaded;
     };
@@ -78,17 +126,30 @@ namespace {
         static std::unordered_map<std::string, FunnelEntry> reg;
         return reg;
     }
+    // Funnels run concurrently on host threads; the lazy first-lookup load must happen
+    // once per key, so lookups serialize on this lock (held across the load).
+    std::mutex& funnel_registry_mutex() {
+        static std::mutex m;
+        return m;
+    }
 }
 
 void parallax_kernel_register(const char* key, const unsigned int* spirv, size_t words) {
+    parallax_kernel_register_flags(key, spirv, words, 0);
+}
+
+void parallax_kernel_register_flags(const char* key, const unsigned int* spirv, size_t words, unsigned flags) {
     if (!key) return;
-    funnel_registry()[key] = FunnelEntry{spirv, words, nullptr, false};
+    std::lock_guard<std::mutex> lock(funnel_registry_mutex());
+    funnel_registry()[key] = FunnelEntry{spirv, words, flags, nullptr, false};
     if (std::getenv("PARALLAX_DEBUG"))
-        std::cerr << "[parallax_kernel_register] " << key << " (" << words << " words)\n";
+        std::cerr << "[parallax_kernel_register] " << key << " (" << words << " words, flags 0x"
+                  << std::hex << flags << std::dec << ")\n";
 }
 
 parallax_kernel_t parallax_kernel_lookup(const char* key) {
     if (!key) return nullptr;
+    std::lock_guard<std::mutex> lock(funnel_registry_mutex());
     auto& reg = funnel_registry();
     auto it = reg.find(key);
     if (it == reg.end()) {
@@ -97,7 +158,7 @@ parallax_kernel_t parallax_kernel_lookup(const char* key) {
         return nullptr;
     }
     if (!it->second.loaded) {
-        it->second.handle = parallax_kernel_load(it->second.spirv, it->second.words);
+        it->second.handle = parallax_kernel_load_flags(it->second.spirv, it->second.words, it->second.flags);
         it->second.loaded = true;
     }
     return it->second.handle;
@@ -119,29 +180,26 @@ void parallax_kernel_launch(parallax_kernel_t kernel, ...) {
     size_t elem_size = va_arg(args, size_t);
     va_end(args);
 
-    std::cout << "[parallax_kernel_launch] Launching kernel: " << handle->name
-              << " with buffer=" << buffer << ", count=" << count
-              << ", elem_size=" << elem_size << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch] Launching kernel: " << handle->pipeline->name
+                  << " with buffer=" << buffer << ", count=" << count
+                  << ", elem_size=" << elem_size << std::endl;
 
-    // Launch kernel
-    bool success = g_kernel_launcher->launch(handle->name, buffer, count, elem_size);
+    // Launch kernel (waits for completion unless deferred)
+    bool success = run_deferred([&] {
+        return g_kernel_launcher->launch(handle->pipeline, buffer, count, elem_size);
+    });
 
     if (!success) {
         std::cerr << "[parallax_kernel_launch] Failed to launch kernel" << std::endl;
         return;
     }
 
-    // Wait for completion
-    std::cout << "[parallax_kernel_launch] Waiting for kernel completion..." << std::endl;
-    g_kernel_launcher->sync();
-
     // Sync back to host
-    auto* memory_manager = parallax::get_global_memory_manager();
-    if (memory_manager) {
-        memory_manager->sync_after_kernel(buffer);
-    }
+    sync_after_completion(buffer);
 
-    std::cout << "[parallax_kernel_launch] Kernel completed successfully" << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch] Kernel completed successfully" << std::endl;
 }
 
 void parallax_kernel_launch_transform(parallax_kernel_t kernel, ...) {
@@ -161,30 +219,27 @@ void parallax_kernel_launch_transform(parallax_kernel_t kernel, ...) {
     size_t elem_size = va_arg(args, size_t);
     va_end(args);
 
-    std::cout << "[parallax_kernel_launch_transform] Launching kernel: " << handle->name
-              << " with in_buffer=" << in_buffer
-              << ", out_buffer=" << out_buffer
-              << ", count=" << count << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_transform] Launching kernel: " << handle->pipeline->name
+                  << " with in_buffer=" << in_buffer
+                  << ", out_buffer=" << out_buffer
+                  << ", count=" << count << std::endl;
 
-    // Launch transform kernel (separate input/output buffers)
-    bool success = g_kernel_launcher->launch_transform(handle->name, in_buffer, out_buffer, count, elem_size);
+    // Launch transform kernel (separate input/output buffers; waits unless deferred)
+    bool success = run_deferred([&] {
+        return g_kernel_launcher->launch_transform(handle->pipeline, in_buffer, out_buffer, count, elem_size);
+    });
 
     if (!success) {
         std::cerr << "[parallax_kernel_launch_transform] Failed to launch kernel" << std::endl;
         return;
     }
 
-    // Wait for completion
-    std::cout << "[parallax_kernel_launch_transform] Waiting for kernel completion..." << std::endl;
-    g_kernel_launcher->sync();
-
     // Sync output buffer back to host
-    auto* memory_manager = parallax::get_global_memory_manager();
-    if (memory_manager) {
-        memory_manager->sync_after_kernel(out_buffer);
-    }
+    sync_after_completion(out_buffer);
 
-    std::cout << "[parallax_kernel_launch_transform] Kernel completed successfully" << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_transform] Kernel completed successfully" << std::endl;
 }
 
 // Transform with distinct input/output element sizes (e.g. float -> double). Fixed
@@ -197,18 +252,20 @@ void parallax_kernel_launch_transform2(parallax_kernel_t kernel, void* in_buffer
         return;
     }
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
-    std::cout << "[parallax_kernel_launch_transform2] Launching kernel: " << handle->name
-              << " in_elem=" << in_elem_size << " out_elem=" << out_elem_size
-              << " count=" << count << std::endl;
-    if (!g_kernel_launcher->launch_transform(handle->name, in_buffer, out_buffer, count,
-                                             in_elem_size, out_elem_size)) {
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_transform2] Launching kernel: " << handle->pipeline->name
+                  << " in_elem=" << in_elem_size << " out_elem=" << out_elem_size
+                  << " count=" << count << std::endl;
+    if (!run_deferred([&] {
+            return g_kernel_launcher->launch_transform(handle->pipeline, in_buffer, out_buffer, count,
+                                                       in_elem_size, out_elem_size);
+        })) {
         std::cerr << "[parallax_kernel_launch_transform2] Failed to launch kernel" << std::endl;
         return;
     }
-    g_kernel_launcher->sync();
-    auto* mm = parallax::get_global_memory_manager();
-    if (mm) mm->sync_after_kernel(out_buffer);
-    std::cout << "[parallax_kernel_launch_transform2] Kernel completed successfully" << std::endl;
+    sync_after_completion(out_buffer);
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_transform2] Kernel completed successfully" << std::endl;
 }
 
 void parallax_kernel_launch_transform2_captures(parallax_kernel_t kernel, void* in_buffer,
@@ -220,18 +277,70 @@ void parallax_kernel_launch_transform2_captures(parallax_kernel_t kernel, void*
         return;
     }
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
-    std::cout << "[parallax_kernel_launch_transform2_captures] Launching kernel: " << handle->name
-              << " in_elem=" << in_elem_size << " out_elem=" << out_elem_size
-              << " count=" << count << " capture_size=" << capture_size << std::endl;
-    if (!g_kernel_launcher->launch_transform(handle->name, in_buffer, out_buffer, count,
-                                             in_elem_size, out_elem_size, captures, capture_size)) {
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_transform2_captures] Launching kernel: " << handle->pipeline->name
+                  << " in_elem=" << in_elem_size << " out_elem=" << out_elem_size
+                  << " count=" << count << " capture_size=" << capture_size << std::endl;
+    if (!run_deferred([&] {
+            return g_kernel_launcher->launch_transform(handle->pipeline, in_buffer, out_buffer, count,
+                                                       in_elem_size, out_elem_size, captures, capture_size);
+        })) {
         std::cerr << "[parallax_kernel_launch_transform2_captures] Failed to launch kernel" << std::endl;
         return;
     }
-    g_kernel_launcher->sync();
-    auto* mm = parallax::get_global_memory_manager();
-    if (mm) mm->sync_after_kernel(out_buffer);
-    std::cout << "[parallax_kernel_launch_transform2_captures] Kernel completed successfully" << std::endl;
+    sync_after_completion(out_buffer);
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_transform2_captures] Kernel completed successfully" << std::endl;
+}
+
+void parallax_launch_batch(const parallax_launch_desc* descs, size_t n) {
+    if (!g_kernel_launcher) {
+        std::cerr << "[parallax_launch_batch] Launcher not initialized" << std::endl;
+        return;
+    }
+    if (!descs || n == 0) return;
+    std::vector<parallax::KernelLauncher::BatchLaunch> launches(n);
+    for (size_t i = 0; i < n; ++i) {
+        const parallax_launch_desc& d = descs[i];
+        if (d.kernel) launches[i].kernel = reinterpret_cast<KernelHandle*>(d.kernel)->pipeline;
+        launches[i].in = d.in;
+        launches[i].out = d.out;
+        launches[i].count = d.count;
+        launches[i].in_elem_size = d.in_elem_size;
+        launches[i].out_elem_size = d.out_elem_size;
+        launches[i].captures = d.captures;
+        launches[i].capture_size = d.capture_size;
+        launches[i].depends = d.depends_on;
+    }
+    // One line per batch, and only when debugging: batches exist to cut per-launch cost.
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_launch_batch] " << n << " launches" << std::endl;
+    if (!run_deferred([&] { return g_kernel_launcher->launch_batch(launches.data(), n); })) {
+        std::cerr << "[parallax_launch_batch] Failed to launch batch" << std::endl;
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) sync_after_completion(descs[i].out ? descs[i].out : descs[i].in);
+}
+
+void parallax_kernel_launch_addressed(parallax_kernel_t kernel, size_t count,
+                                      void* const* arrays, const size_t* elem_sizes,
+                                      size_t num_arrays) {
+    if (!kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_kernel_launch_addressed] Invalid kernel or launcher" << std::endl;
+        return;
+    }
+    auto* handle = reinterpret_cast<KernelHandle*>(kernel);
+    // Only when debugging: addressed launches exist to cut per-launch cost.
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_addressed] " << handle->pipeline->name
+                  << " arrays=" << num_arrays << " count=" << count << std::endl;
+    if (!run_deferred([&] {
+            return g_kernel_launcher->launch_addressed(handle->pipeline, count, arrays, elem_sizes, num_arrays);
+        })) {
+        std::cerr << "[parallax_kernel_launch_addressed] Failed to launch kernel" << std::endl;
+        return;
+    }
+    for (size_t i = 0; i < num_arrays; ++i) sync_after_completion(arrays[i]);
 }
 
 // NEW V2: Kernel launch with captured parameters (for function objects)
@@ -250,32 +359,29 @@ void parallax_kernel_launch_with_captures(
 
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
 
-    std::cout << "[parallax_kernel_launch_with_captures] Launching kernel: " << handle->name
-              << " with buffer=" << buffer
-              << ", count=" << count
-              << ", captures=" << captures
-              << ", capture_size=" << capture_size << std::endl;
-
-    // Launch kernel with captures
-    bool success = g_kernel_launcher->launch_with_captures(
-        handle->name, buffer, count, captures, capture_size, elem_size);
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_with_captures] Launching kernel: " << handle->pipeline->name
+                  << " with buffer=" << buffer
+                  << ", count=" << count
+                  << ", captures=" << captures
+                  << ", capture_size=" << capture_size << std::endl;
+
+    // Launch kernel with captures (waits unless deferred)
+    bool success = run_deferred([&] {
+        return g_kernel_launcher->launch_with_captures(
+            handle->pipeline, buffer, count, captures, capture_size, elem_size);
+    });
 
     if (!success) {
         std::cerr << "[parallax_kernel_launch_with_captures] Failed to launch kernel" << std::endl;
         return;
     }
 
-    // Wait for completion
-    std::cout << "[parallax_kernel_launch_with_captures] Waiting for kernel completion..." << std::endl;
-    g_kernel_launcher->sync();
-
     // Sync buffer back to host
-    auto* memory_manager = parallax::get_global_memory_manager();
-    if (memory_manager) {
-        memory_manager->sync_after_kernel(buffer);
-    }
+    sync_after_completion(buffer);
 
-    std::cout << "[parallax_kernel_launch_with_captures] Kernel completed successfully" << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_kernel_launch_with_captures] Kernel completed successfully" << std::endl;
 }
 
 void parallax_reduce(parallax_kernel_t kernel, void* data, size_t count,
@@ -285,9 +391,10 @@ void parallax_reduce(parallax_kernel_t kernel, void* data, size_t count,
         return;
     }
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
-    std::cout << "[parallax_reduce] Reducing kernel: " << handle->name
-              << " count=" << count << " elem_size=" << elem_size << std::endl;
-    if (!g_kernel_launcher->launch_reduce(handle->name, data, count, elem_size, result)) {
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_reduce] Reducing kernel: " << handle->pipeline->name
+                  << " count=" << count << " elem_size=" << elem_size << std::endl;
+    if (!g_kernel_launcher->launch_reduce(handle->pipeline, data, count, elem_size, result)) {
         std::cerr << "[parallax_reduce] reduction failed" << std::endl;
     }
 }
@@ -299,7 +406,7 @@ size_t parallax_argminmax(parallax_kernel_t kernel, void* data, size_t count,
         return count;
     }
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
-    return g_kernel_launcher->launch_argminmax(handle->name, data, count, elem_size,
+    return g_kernel_launcher->launch_argminmax(handle->pipeline, data, count, elem_size,
                                                is_float != 0, want_max != 0, want_last != 0);
 }
 
@@ -310,7 +417,7 @@ size_t parallax_find(parallax_kernel_t kernel, void* data, size_t count,
         return count;
     }
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
-    return g_kernel_launcher->launch_find(handle->name, data, count, elem_size, negate != 0, value);
+    return g_kernel_launcher->launch_find(handle->pipeline, data, count, elem_size, negate != 0, value);
 }
 
 size_t parallax_mismatch(parallax_kernel_t kernel, void* a, void* b, size_t count, size_t elem_size) {
@@ -319,7 +426,7 @@ size_t parallax_mismatch(parallax_kernel_t kernel, void* a, void* b, size_t coun
         return count;
     }
     auto* handle = reinterpret_cast<KernelHandle*>(kernel);
-    return g_kernel_launcher->launch_mismatch(handle->name, a, b, count, elem_size);
+    return g_kernel_launcher->launch_mismatch(handle->pipeline, a, b, count, elem_size);
 }
 
 void parallax_scan(parallax_kernel_t scan_kernel, parallax_kernel_t add_kernel,
@@ -330,9 +437,12 @@ void parallax_scan(parallax_kernel_t scan_kernel, parallax_kernel_t add_kernel,
     }
     auto* sh = reinterpret_cast<KernelHandle*>(scan_kernel);
     auto* ah = reinterpret_cast<KernelHandle*>(add_kernel);
-    std::cout << "[parallax_scan] scan=" << sh->name << " add=" << ah->name
-              << " count=" << count << " elem_size=" << elem_size << std::endl;
-    if (!g_kernel_launcher->launch_scan(sh->name, ah->name, data, count, elem_size)) {
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_scan] scan=" << sh->pipeline->name << " add=" << ah->pipeline->name
+                  << " count=" << count << " elem_size=" << elem_size << std::endl;
+    if (!run_deferred([&] {
+            return g_kernel_launcher->launch_scan(sh->pipeline, ah->pipeline, data, count, elem_size);
+        })) {
         std::cerr << "[parallax_scan] scan failed" << std::endl;
     }
 }
@@ -347,10 +457,13 @@ void parallax_exclusive_scan(parallax_kernel_t scan_kernel, parallax_kernel_t ad
     auto* sh = reinterpret_cast<KernelHandle*>(scan_kernel);
     auto* ah = reinterpret_cast<KernelHandle*>(add_kernel);
     auto* hh = reinterpret_cast<KernelHandle*>(shift_kernel);
-    std::cout << "[parallax_exclusive_scan] scan=" << sh->name << " shift=" << hh->name
-              << " count=" << count << " elem_size=" << elem_size << std::endl;
-    if (!g_kernel_launcher->launch_exclusive_scan(sh->name, ah->name, hh->name,
-                                                  input, output, count, elem_size, init)) {
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_exclusive_scan] scan=" << sh->pipeline->name << " shift=" << hh->pipeline->name
+                  << " count=" << count << " elem_size=" << elem_size << std::endl;
+    if (!run_deferred([&] {
+            return g_kernel_launcher->launch_exclusive_scan(sh->pipeline, ah->pipeline, hh->pipeline,
+                                                            input, output, count, elem_size, init);
+        })) {
         std::cerr << "[parallax_exclusive_scan] scan failed" << std::endl;
     }
 }
@@ -361,36 +474,327 @@ void parallax_sort(parallax_kernel_t kernel, void* data, size_t count, size_t el
         return;
     }
     auto* h = reinterpret_cast<KernelHandle*>(kernel);
-    std::cout << "[parallax_sort] kernel=" << h->name << " count=" << count
-              << " elem_size=" << elem_size << std::endl;
-    if (!g_kernel_launcher->launch_sort(h->name, data, count, elem_size)) {
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[parallax_sort] kernel=" << h->pipeline->name << " count=" << count
+                  << " elem_size=" << elem_size << std::endl;
+    if (!run_deferred([&] {
+            return g_kernel_launcher->launch_sort(h->pipeline, data, count, elem_size);
+        })) {
         std::cerr << "[parallax_sort] sort failed" << std::endl;
     }
 }
 
-size_t parallax_copy_if(parallax_kernel_t flags_kernel, parallax_kernel_t scan_kernel,
-                        parallax_kernel_t add_kernel, parallax_kernel_t scatter_kernel,
-                        void* input, void* output, size_t count, size_t elem_size,
-                        int elem_is_float) {
+static size_t run_compaction(const char* tag, parallax_kernel_t flags_kernel, parallax_kernel_t scan_kernel,
+                             parallax_kernel_t add_kernel, parallax_kernel_t scatter_kernel,
+                             void* input, void* output, size_t count, size_t elem_size,
+                             int elem_is_float, bool scatter_needs_kept) {
     if (!flags_kernel || !scan_kernel || !add_kernel || !scatter_kernel || !g_kernel_launcher) {
-        std::cerr << "[parallax_copy_if] invalid kernels or launcher" << std::endl;
+        std::cerr << "[" << tag << "] invalid kernels or launcher" << std::endl;
         return 0;
     }
     auto* fh = reinterpret_cast<KernelHandle*>(flags_kernel);
     auto* sh = reinterpret_cast<KernelHandle*>(scan_kernel);
     auto* ah = reinterpret_cast<KernelHandle*>(add_kernel);
     auto* xh = reinterpret_cast<KernelHandle*>(scatter_kernel);
-    std::cout << "[parallax_copy_if] count=" << count << " elem_size=" << elem_size << std::endl;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[" << tag << "] count=" << count << " elem_size=" << elem_size << std::endl;
     size_t kept = 0;
-    if (!g_kernel_launcher->launch_compact(fh->name, sh->name, ah->name, xh->name,
+    if (!g_kernel_launcher->launch_compact(fh->pipeline, sh->pipeline, ah->pipeline, xh->pipeline,
                                            input, output, count, elem_size,
-                                           elem_is_float != 0, &kept)) {
-        std::cerr << "[parallax_copy_if] compaction failed" << std::endl;
+                                           elem_is_float != 0, &kept, scatter_needs_kept)) {
+        std::cerr << "[" << tag << "] compaction failed" << std::endl;
         return 0;
     }
     return kept;
 }
 
+size_t parallax_copy_if(parallax_kernel_t flags_kernel, parallax_kernel_t scan_kernel,
+                        parallax_kernel_t add_kernel, parallax_kernel_t scatter_kernel,
+                        void* input, void* output, size_t count, size_t elem_size,
+                        int elem_is_float) {
+    return run_compaction("parallax_copy_if", flags_kernel, scan_kernel, add_kernel, scatter_kernel,
+                          input, output, count, elem_size, elem_is_float, false);
+}
+
+size_t parallax_partition(parallax_kernel_t flags_kernel, parallax_kernel_t scan_kernel,
+                          parallax_kernel_t add_kernel, parallax_kernel_t scatter_kernel,
+                          void* input, void* output, size_t count, size_t elem_size,
+                          int elem_is_float) {
+    return run_compaction("parallax_partition", flags_kernel, scan_kernel, add_kernel, scatter_kernel,
+                          input, output, count, elem_size, elem_is_float, true);
+}
+
+// ---------------------------------------------------------------------------
+// Async streams/events. A stream remembers the submission serial of the last launch
+// issued on it; an event snapshots a serial. The launcher tracks completion per serial
+// and runs each launch's host epilogue (result copies, downloads) when it completes.
+// ---------------------------------------------------------------------------
+struct parallax_stream {
+    uint64_t last_serial = 0;
+};
+
+struct parallax_event {
+    uint64_t serial = 0;
+};
+
+namespace {
+    // Run one launcher call with async submission and note its serial on `stream`.
+    template <class F>
+    bool run_on_stream(parallax_stream_t stream, F&& fn) {
+        g_kernel_launcher->set_async(true);
+        const bool ok = fn();
+        g_kernel_launcher->set_async(false);
+        if (stream) stream->last_serial = g_kernel_launcher->last_submission();
+        return ok;
+    }
+
+    uint64_t stream_serial(parallax_stream_t stream) {
+        if (stream) return stream->last_serial;
+        return g_kernel_launcher ? g_kernel_launcher->last_submission() : 0;
+    }
+}
+
+parallax_stream_t parallax_stream_create(void) {
+    return new parallax_stream{};
+}
+
+void parallax_stream_destroy(parallax_stream_t stream) {
+    // Outstanding work still completes; its epilogues are owned by the launcher.
+    delete stream;
+}
+
+void parallax_stream_synchronize(parallax_stream_t stream) {
+    if (!g_kernel_launcher) return;
+    g_kernel_launcher->wait_for(stream_serial(stream));
+}
+
+parallax_event_t parallax_event_create(void) {
+    return new parallax_event{};
+}
+
+void parallax_event_destroy(parallax_event_t event) {
+    delete event;
+}
+
+void parallax_event_record(parallax_event_t event, parallax_stream_t stream) {
+    if (!event) return;
+    event->serial = stream_serial(stream);
+}
+
+void parallax_event_wait(parallax_event_t event) {
+    if (!event || !g_kernel_launcher) return;
+    g_kernel_launcher->wait_for(event->serial);
+}
+
+int parallax_event_query(parallax_event_t event) {
+    if (!event || !g_kernel_launcher) return 1;
+    return g_kernel_launcher->is_complete(event->serial) ? 1 : 0;
+}
+
+void parallax_kernel_launch_async(parallax_stream_t stream, parallax_kernel_t kernel,
+                                  void* buffer, size_t count, size_t elem_size) {
+    if (!kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_kernel_launch_async] Invalid kernel or launcher not initialized" << std::endl;
+        return;
+    }
+    auto* handle = reinterpret_cast<KernelHandle*>(kernel);
+    const bool ok = run_on_stream(stream, [&] {
+        if (!g_kernel_launcher->launch(handle->pipeline, buffer, count, elem_size)) return false;
+        // Same host sync-back as parallax_kernel_launch, once the kernel completed.
+        sync_after_completion(buffer);
+        return true;
+    });
+    if (!ok) std::cerr << "[parallax_kernel_launch_async] Failed to launch kernel" << std::endl;
+}
+
+void parallax_reduce_async(parallax_stream_t stream, parallax_kernel_t kernel, void* data,
+                           size_t count, size_t elem_size, void* result) {
+    if (!kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_reduce_async] Invalid kernel or launcher not initialized" << std::endl;
+        return;
+    }
+    auto* handle = reinterpret_cast<KernelHandle*>(kernel);
+    if (!run_on_stream(stream, [&] {
+            return g_kernel_launcher->launch_reduce(handle->pipeline, data, count, elem_size, result);
+        })) {
+        std::cerr << "[parallax_reduce_async] reduction failed" << std::endl;
+    }
+}
+
+void parallax_scan_async(parallax_stream_t stream, parallax_kernel_t scan_kernel,
+                         parallax_kernel_t add_kernel, void* data, size_t count, size_t elem_size) {
+    if (!scan_kernel || !add_kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_scan_async] invalid kernels or launcher" << std::endl;
+        return;
+    }
+    auto* sh = reinterpret_cast<KernelHandle*>(scan_kernel);
+    auto* ah = reinterpret_cast<KernelHandle*>(add_kernel);
+    if (!run_on_stream(stream, [&] {
+            return g_kernel_launcher->launch_scan(sh->pipeline, ah->pipeline, data, count, elem_size);
+        })) {
+        std::cerr << "[parallax_scan_async] scan failed" << std::endl;
+    }
+}
+
+void parallax_sort_async(parallax_stream_t stream, parallax_kernel_t kernel, void* data,
+                         size_t count, size_t elem_size) {
+    if (!kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_sort_async] invalid kernel or launcher" << std::endl;
+        return;
+    }
+    auto* h = reinterpret_cast<KernelHandle*>(kernel);
+    if (!run_on_stream(stream, [&] {
+            return g_kernel_launcher->launch_sort(h->pipeline, data, count, elem_size);
+        })) {
+        std::cerr << "[parallax_sort_async] sort failed" << std::endl;
+    }
+}
+
+void parallax_copy_if_async(parallax_stream_t stream, parallax_kernel_t flags_kernel,
+                            parallax_kernel_t scan_kernel, parallax_kernel_t add_kernel,
+                            parallax_kernel_t scatter_kernel, void* input, void* output,
+                            size_t count, size_t elem_size, int elem_is_float, size_t* kept) {
+    if (!flags_kernel || !scan_kernel || !add_kernel || !scatter_kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_copy_if_async] invalid kernels or launcher" << std::endl;
+        return;
+    }
+    auto* fh = reinterpret_cast<KernelHandle*>(flags_kernel);
+    auto* sh = reinterpret_cast<KernelHandle*>(scan_kernel);
+    auto* ah = reinterpret_cast<KernelHandle*>(add_kernel);
+    auto* xh = reinterpret_cast<KernelHandle*>(scatter_kernel);
+    if (!run_on_stream(stream, [&] {
+            return g_kernel_launcher->launch_compact(fh->pipeline, sh->pipeline, ah->pipeline, xh->pipeline,
+                                                     input, output, count, elem_size,
+                                                     elem_is_float != 0, kept);
+        })) {
+        std::cerr << "[parallax_copy_if_async] compaction failed" << std::endl;
+    }
+}
+
+void parallax_kernel_launch_with_captures_async(parallax_stream_t stream, parallax_kernel_t kernel,
+                                                void* buffer, size_t count, void* captures,
+                                                size_t capture_size, size_t elem_size) {
+    if (!kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_kernel_launch_with_captures_async] invalid kernel or launcher" << std::endl;
+        return;
+    }
+    auto* handle = reinterpret_cast<KernelHandle*>(kernel);
+    if (!run_on_stream(stream, [&] {
+            if (!g_kernel_launcher->launch_with_captures(handle->pipeline, buffer, count, captures,
+                                                         capture_size, elem_size))
+                return false;
+            sync_after_completion(buffer);
+            return true;
+        })) {
+        std::cerr << "[parallax_kernel_launch_with_captures_async] Failed to launch kernel" << std::endl;
+    }
+}
+
+void parallax_kernel_launch_transform2_async(parallax_stream_t stream, parallax_kernel_t kernel,
+                                             void* in_buffer, void* out_buffer, size_t count,
+                                             size_t in_elem_size, size_t out_elem_size,
+                                             void* captures, size_t capture_size) {
+    if (!kernel || !g_kernel_launcher) {
+        std::cerr << "[parallax_kernel_launch_transform2_async] invalid kernel or launcher" << std::endl;
+        return;
+    }
+    auto* handle = reinterpret_cast<KernelHandle*>(kernel);
+    if (!run_on_stream(stream, [&] {
+            if (!g_kernel_launcher->launch_transform(handle->pipeline, in_buffer, out_buffer, count,
+                                                     in_elem_size, out_elem_size,
+                                                     captures, captures ? capture_size : 0))
+                return false;
+            sync_after_completion(out_buffer);
+            return true;
+        })) {
+        std::cerr << "[parallax_kernel_launch_transform2_async] Failed to launch kernel" << std::endl;
+    }
+}
+
+// Submits whatever PARALLAX_LAZY left recorded on this thread and waits for it.
+void parallax_flush(void) {
+    if (!lazy_enabled() || !g_kernel_launcher) return;
+    g_kernel_launcher->sync();
+}
+
+void parallax_set_wait_mode(int mode) {
+    if (mode != PARALLAX_WAIT_LATENCY && mode != PARALLAX_WAIT_EFFICIENT) {
+        std::cerr << "[parallax_set_wait_mode] unknown mode " << mode
+                  << " (PARALLAX_WAIT_LATENCY or PARALLAX_WAIT_EFFICIENT)" << std::endl;
+        return;
+    }
+    auto* backend = parallax::get_global_backend();
+    if (!backend) return;
+    backend->set_wait_mode(mode == PARALLAX_WAIT_EFFICIENT ? parallax::WaitMode::Efficiency
+                                                           : parallax::WaitMode::Latency);
+}
+
+void parallax_set_priority(int priority) {
+    if (!ensure_kernel_launcher_initialized()) return;
+    g_kernel_launcher->set_priority(priority == PARALLAX_PRIORITY_HIGH  ? parallax::LaunchPriority::High
+                                    : priority == PARALLAX_PRIORITY_LOW ? parallax::LaunchPriority::Low
+                                                                        : parallax::LaunchPriority::Normal);
+}
+
+// ---------------------------------------------------------------------------
+// Launch graphs. A parallax_graph_t is the launcher's graph itself; the launcher owns
+// it (and frees what is left at shutdown).
+// ---------------------------------------------------------------------------
+namespace {
+    parallax::KernelLauncher::Graph* as_graph(parallax_graph_t graph) {
+        return reinterpret_cast<parallax::KernelLauncher::Graph*>(graph);
+    }
+}
+
+void parallax_graph_begin(void) {
+    if (!ensure_kernel_launcher_initialized() || !g_kernel_launcher->begin_capture())
+        std::cerr << "[parallax_graph_begin] capture not started" << std::endl;
+}
+
+parallax_graph_t parallax_graph_end(void) {
+    if (!g_kernel_launcher) return nullptr;
+    return reinterpret_cast<parallax_graph_t>(g_kernel_launcher->end_capture());
+}
+
+int parallax_graph_capturing(void) {
+    return g_kernel_launcher && g_kernel_launcher->capturing() ? 1 : 0;
+}
+
+void parallax_graph_launch(parallax_graph_t graph) {
+    if (!graph || !g_kernel_launcher) {
+        std::cerr << "[parallax_graph_launch] invalid graph or launcher" << std::endl;
+        return;
+    }
+    if (!g_kernel_launcher->launch_graph(as_graph(graph)))
+        std::cerr << "[parallax_graph_launch] replay failed" << std::endl;
+}
+
+void parallax_graph_launch_async(parallax_stream_t stream, parallax_graph_t graph) {
+    if (!graph || !g_kernel_launcher) {
+        std::cerr << "[parallax_graph_launch_async] invalid graph or launcher" << std::endl;
+        return;
+    }
+    if (!run_on_stream(stream, [&] { return g_kernel_launcher->launch_graph(as_graph(graph)); }))
+        std::cerr << "[parallax_graph_launch_async] replay failed" << std::endl;
+}
+
+int parallax_graph_set_captures(parallax_graph_t graph, size_t index, const void* captures,
+                                size_t size) {
+    if (!graph || !captures || !g_kernel_launcher) return 0;
+    return g_kernel_launcher->set_graph_captures(as_graph(graph), index, captures, size) ? 1 : 0;
+}
+
+void parallax_graph_destroy(parallax_graph_t graph) {
+    if (!graph || !g_kernel_launcher) return;
+    g_kernel_launcher->destroy_graph(as_graph(graph));
+}
+
+namespace parallax {
+void abort_graph_capture(const char* reason) {
+    if (g_kernel_launcher) g_kernel_launcher->abort_capture(reason);
+}
+}  // namespace parallax
+
 bool parallax_register_buffer(void* ptr, size_t size) {
     auto* memory_manager = parallax::get_global_memory_manager();
     if (!memory_manager) {
@@ -1,28 +1,41 @@
 #include "parallax/kernel_launcher.hpp"
 #include "parallax/runtime.hpp"
 #include "parallax/arena.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace parallax {
 
 namespace {
 // Push-constant block shared by all compute dispatches. Mirrors the compiler's
-// setup_push_constants layout: count @0, host_base @8, dev_base @16. Ordinary
-// kernels read only count; pointer-chasing kernels relocate stored host pointers
-// with gpu = dev_base + (host_ptr - host_base), so the arena bases travel here.
+// setup_push_constants layout: count @0, host_base @8, dev_base @16, base @24.
+// Ordinary kernels read only count; pointer-chasing kernels relocate stored host
+// pointers with gpu = dev_base + (host_ptr - host_base), so the arena bases travel
+// here. count is 64-bit, but one dispatch never covers 2^31 elements (see
+// dispatch_limit), so kernels declaring `uint count` read its low word exactly. A
+// launch too large for one dispatch is recorded in chunks: each sees its own count
+// and its arrays bound at the chunk, and `base` is the index of its first element in
+// the whole range, for kernels whose result depends on the global index.
 struct PushBlock {
-    uint32_t count;
-    uint32_t pad;
+    uint64_t count;
     uint64_t host_base;
     uint64_t dev_base;
+    uint64_t base;
 };
-static_assert(sizeof(PushBlock) == 24, "push-constant block must be 24 bytes");
+static_assert(sizeof(PushBlock) == KernelLauncher::kPushHeaderSize, "push-constant block must be 32 bytes");
 
-PushBlock make_push_block(size_t count) {
+PushBlock make_push_block(size_t count, size_t base = 0) {
     PushBlock pc{};
-    pc.count = static_cast<uint32_t>(count);
+    pc.count = count;
+    pc.base = base;
     UnifiedArena* arena = get_global_arena();
     if (arena) {
         pc.host_base = reinterpret_cast<uint64_t>(arena->host_base());
@@ -36,96 +49,694 @@ PushBlock make_push_block(size_t count) {
 // depth counter makes only the OUTERMOST operation migrate, so a primitive that calls
 // another (launch_compact -> launch_scan) keeps all intermediate data on the device
 // instead of clobbering it with stale host data. No-op on UMA (arena->uma()).
-int g_arena_sync_depth = 0;
+// The migration back is queued with when_complete(), so with async submission it runs
+// once the work has finished rather than racing it. Before the flush the scope retires
+// only the calling thread's own submissions; the copy itself is submitted after
+// everything on every queue and waited on alone. g_staging_mutex is held just around
+// each whole-arena copy (UMA stays lock-free), not across the operation: on a staging
+// arena, threads whose launches share arena data must still order them themselves.
+// Deferred launches share one migration per recording instead: the launch that opens
+// it flushes and stages it, the ones appended after it skip the flush, and
+// submit_recording() queues the migration back (see recording_staged()). Host writes
+// between deferred launches therefore reach the device only once the recording is
+// submitted and the next one opens.
+// Launches captured into a graph do not migrate: the replay does, around the whole graph.
+thread_local int g_arena_sync_depth = 0;
+std::mutex g_staging_mutex;
+void migrate_to_device(UnifiedArena* arena) {
+    std::lock_guard<std::mutex> lock(g_staging_mutex);
+    arena->flush_to_device();
+}
+void migrate_from_device(UnifiedArena* arena) {
+    std::lock_guard<std::mutex> lock(g_staging_mutex);
+    arena->invalidate_from_device();
+}
 struct ArenaSyncScope {
-    UnifiedArena* arena = nullptr;
-    ArenaSyncScope() {
-        if (g_arena_sync_depth++ == 0) {
-            arena = get_global_arena();
-            if (arena) arena->flush_to_device();
+    KernelLauncher* launcher;
+    UnifiedArena* arena = nullptr;  // migrates back when the scope ends
+    bool deferred = false;          // migrates back when the recording is submitted
+    explicit ArenaSyncScope(KernelLauncher* l) : launcher(l) {
+        if (g_arena_sync_depth++ == 0 && !launcher->capturing()) {
+            UnifiedArena* a = get_global_arena();
+            if (a && !a->uma()) {
+                deferred = launcher->deferring();
+                if (!deferred || !launcher->recording_staged()) {
+                    launcher->sync();
+                    launcher->stage_recording(deferred);
+                    migrate_to_device(a);
+                }
+                if (!deferred) arena = a;
+            }
         }
     }
     ~ArenaSyncScope() {
-        if (--g_arena_sync_depth == 0 && arena) arena->invalidate_from_device();
+        if (--g_arena_sync_depth != 0) return;
+        if (arena) {
+            UnifiedArena* a = arena;
+            launcher->when_complete([a] { migrate_from_device(a); });
+        } else if (deferred && !launcher->recording_staged()) {
+            launcher->stage_recording(false);  // nothing left open to migrate back
+        }
+    }
+};
+
+// Execution + memory dependency between two dispatches recorded into the same command
+// buffer: shader writes of the earlier dispatch become visible to shader reads/writes of
+// the next. Lets a multi-pass primitive run as one submission instead of one per pass.
+void record_compute_barrier(VkCommandBuffer cmd) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+// Leading barrier of every submission on a device without a timeline semaphore (with
+// one, VulkanBackend::submit orders each submission after the previous one instead).
+// Frames in flight are not host-serialized, so order this submission's shader/transfer
+// accesses after those of earlier ones. Also separates the appended launches of a
+// deferred recording and the hazardous nodes of a graph.
+void record_submission_barrier(VkCommandBuffer cmd) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                            VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    const VkPipelineStageFlags stages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    vkCmdPipelineBarrier(cmd, stages, stages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+// What the launcher needs to know about a SPIR-V module. The workgroup x size, and
+// the specialization constant that sets it (-1 when it is a literal), cover the three
+// ways glslang emits it: LocalSize, a WorkgroupSize builtin composite
+// (local_size_x_id; overrides the execution mode), and LocalSizeId. A module that
+// reads gl_NumWorkGroups is taken to linearize its workgroup id as
+// y * gl_NumWorkGroups.x + x, so it can be dispatched as a 2D grid. A module with
+// PhysicalStorageBuffer64 addressing and no descriptor bindings is an address-ABI
+// kernel (see PipelineData::address_abi). A binding whose variable is NonWritable, or
+// whose block has every member NonWritable (GLSL `readonly buffer`), is read-only.
+struct ShaderInfo {
+    uint32_t size = 256;
+    int32_t spec_id = -1;
+    bool grid_2d = false;
+    bool physical_addressing = false;
+    bool descriptors = false;
+    uint32_t readonly_bindings = 0;
+    bool address_abi() const { return physical_addressing && !descriptors; }
+};
+
+ShaderInfo parse_shader(const uint32_t* code, size_t words) {
+    ShaderInfo info;
+    std::unordered_map<uint32_t, uint32_t> values;    // constant id -> value
+    std::unordered_map<uint32_t, uint32_t> spec_ids;  // constant id -> SpecId
+    uint32_t builtin = 0, x_id = 0, builtin_x = 0;
+    std::unordered_map<uint32_t, uint32_t> binding_of;        // variable id -> Binding
+    std::unordered_map<uint32_t, uint32_t> nonwritable;       // variable or block id -> NonWritable members
+    std::unordered_map<uint32_t, uint32_t> members, pointee;  // block -> member count, pointer -> type
+    std::unordered_map<uint32_t, uint32_t> variable_type;     // variable id -> pointer type
+    for (size_t i = 5; i < words;) {
+        const uint32_t count = code[i] >> 16, op = code[i] & 0xffff;
+        if (count == 0 || i + count > words) break;
+        const uint32_t* w = code + i;
+        if (op == 16 && count >= 4 && w[2] == 17) info.size = w[3];                   // OpExecutionMode LocalSize
+        else if (op == 331 && count >= 4 && w[2] == 38) x_id = w[3];                  // OpExecutionModeId LocalSizeId
+        else if (op == 71 && count >= 4 && w[2] == 1) spec_ids[w[1]] = w[3];          // OpDecorate SpecId
+        else if (op == 71 && count >= 4 && w[2] == 11 && w[3] == 25) builtin = w[1];  // BuiltIn WorkgroupSize
+        else if (op == 71 && count >= 4 && w[2] == 11 && w[3] == 24) info.grid_2d = true;  // NumWorkgroups
+        else if (op == 71 && count >= 3 && (w[2] == 33 || w[2] == 34)) info.descriptors = true;  // Binding/DescriptorSet
+        else if (op == 14 && count >= 3 && w[1] == 5348) info.physical_addressing = true;  // OpMemoryModel PSB64
+        else if ((op == 43 || op == 50) && count >= 4) values[w[2]] = w[3];           // Op(Spec)Constant
+        else if ((op == 44 || op == 51) && count >= 4 && w[2] == builtin) builtin_x = w[3];  // composite
+        // Storage access: which variable is which binding, and what is NonWritable.
+        if (op == 71 && count >= 4 && w[2] == 33) binding_of[w[1]] = w[3];           // OpDecorate Binding
+        else if (op == 71 && count >= 3 && w[2] == 24) ++nonwritable[w[1]];          // OpDecorate NonWritable
+        else if (op == 72 && count >= 4 && w[3] == 24) ++nonwritable[w[1]];          // OpMemberDecorate NonWritable
+        else if (op == 30) members[w[1]] = count - 2;                                // OpTypeStruct
+        else if (op == 32 && count >= 4) pointee[w[1]] = w[3];                       // OpTypePointer
+        else if (op == 59 && count >= 4) variable_type[w[2]] = w[1];                 // OpVariable
+        i += count;
+    }
+    if (builtin_x) x_id = builtin_x;
+    for (const auto& [variable, binding] : binding_of) {
+        if (binding >= 4) continue;
+        const uint32_t block = pointee[variable_type[variable]];
+        const auto m = members.find(block);
+        if (nonwritable.count(variable) || (m != members.end() && m->second > 0 && nonwritable[block] == m->second))
+            info.readonly_bindings |= 1u << binding;
+    }
+    if (x_id) {
+        if (auto v = values.find(x_id); v != values.end()) info.size = v->second;
+        if (auto s = spec_ids.find(x_id); s != spec_ids.end()) info.spec_id = static_cast<int32_t>(s->second);
+    }
+    return info;
+}
+
+// FNV-1a over the module: the tuner's key for a kernel, stable across runs.
+uint64_t hash_spirv(const uint32_t* code, size_t bytes) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(code);
+    for (size_t i = 0; i < bytes; ++i) h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+}  // namespace
+
+namespace {
+std::atomic<uint64_t> g_launcher_instances{0};
+
+// Live launchers by instance id, for the thread-exit hook below, each with the number
+// of exiting threads releasing their context in it right now. Never freed: threads
+// may exit during static destruction.
+struct LiveLauncher {
+    KernelLauncher* launcher = nullptr;
+    uint32_t releasing = 0;
+};
+std::mutex& live_launchers_mutex() {
+    static auto* mutex = new std::mutex;
+    return *mutex;
+}
+std::condition_variable& live_launchers_released() {
+    static auto* released = new std::condition_variable;
+    return *released;
+}
+std::unordered_map<uint64_t, LiveLauncher>& live_launchers() {
+    static auto* launchers = new std::unordered_map<uint64_t, LiveLauncher>;
+    return *launchers;
+}
+
+// Releases the exiting thread's context in every launcher it launched through that is
+// still alive. The registry lock is held only to pin the launcher (its destructor waits
+// for `releasing` to drop back to zero), not across the release itself.
+struct ThreadExit {
+    std::vector<uint64_t> launchers;
+    ~ThreadExit() {
+        const std::vector<uint64_t> ids = std::move(launchers);
+        launchers.clear();
+        for (uint64_t id : ids) {
+            KernelLauncher* launcher = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(live_launchers_mutex());
+                auto it = live_launchers().find(id);
+                if (it == live_launchers().end()) continue;
+                launcher = it->second.launcher;
+                ++it->second.releasing;
+            }
+            launcher->release_thread();
+            {
+                std::lock_guard<std::mutex> lock(live_launchers_mutex());
+                --live_launchers()[id].releasing;
+            }
+            live_launchers_released().notify_all();
+        }
     }
 };
+thread_local ThreadExit t_thread_exit;
 }  // namespace
 
 KernelLauncher::KernelLauncher(VulkanBackend* backend, MemoryManager* memory_manager)
-    : backend_(backend), memory_manager_(memory_manager) {
-    
-    // Create descriptor pool with support for both storage and uniform buffers
-    std::vector<VkDescriptorPoolSize> pool_sizes(2);
-    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    pool_sizes[0].descriptorCount = 6144; // up to 3 storage bindings per set
-    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    pool_sizes[1].descriptorCount = 2048; // For captures buffers
+    : backend_(backend), memory_manager_(memory_manager),
+      instance_id_(++g_launcher_instances) {
+    {
+        std::lock_guard<std::mutex> lock(live_launchers_mutex());
+        live_launchers()[instance_id_].launcher = this;
+    }
+    // Push descriptors when the device has them (the backend resolved the entry point);
+    // otherwise every dispatch binds a set from the calling thread's descriptor pool.
+    push_descriptor_ = backend_->cmd_push_descriptor_set();
+    // Binding 2 of every non-capturing dispatch: one zero-filled uniform, shared by
+    // all threads and never written again (so it is safe to bind while in flight).
+    void* zero = nullptr;
+    if (create_host_buffer(kZeroUniformSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                           zero_uniform_buffer_, zero_uniform_memory_, &zero)) {
+        std::memset(zero, 0, kZeroUniformSize);
+    } else {
+        std::cerr << "Failed to create zero uniform buffer" << std::endl;
+    }
+    // Workgroup-size tuning needs timestamps on the compute queue. Candidates are the
+    // powers of two from 64 to 1024 within the device's workgroup limits, assuming up
+    // to 16 bytes of shared memory per invocation (the library kernels use 4 or 8).
+    const DeviceCapabilities& caps = backend_->capabilities();
+    if (std::getenv("PARALLAX_NO_AUTOTUNE")) {
+        std::cout << "[KernelLauncher] Workgroup autotuning disabled (PARALLAX_NO_AUTOTUNE)" << std::endl;
+    } else if (caps.timestamp_valid_bits == 0) {
+        std::cout << "[KernelLauncher] No compute timestamps; workgroup sizes are not tuned" << std::endl;
+    } else {
+        tuner_ = std::make_unique<WorkgroupTuner>(caps.device_uuid);
+        timestamp_mask_ = caps.timestamp_valid_bits >= 64 ? ~0ull : (1ull << caps.timestamp_valid_bits) - 1;
+        timestamp_period_ = caps.timestamp_period;
+        const VkPhysicalDeviceLimits& limits = backend_->limits();
+        for (uint32_t size = 64; size <= 1024; size <<= 1) {
+            if (size <= limits.maxComputeWorkGroupSize[0] && size <= limits.maxComputeWorkGroupInvocations &&
+                size * 16 <= limits.maxComputeSharedMemorySize)
+                workgroup_candidates_.push_back(size);
+        }
+    }
+    if (std::getenv("PARALLAX_NO_REPLAY_CACHE")) {
+        replay_cache_ = false;
+        std::cout << "[KernelLauncher] Replay cache disabled (PARALLAX_NO_REPLAY_CACHE)" << std::endl;
+    }
+    // Launch contexts are created lazily, on each thread's first launch (ctx()).
+}
 
-    VkDescriptorPoolCreateInfo pool_info{};
-    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
-    pool_info.pPoolSizes = pool_sizes.data();
-    pool_info.maxSets = 1024;
-    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+bool KernelLauncher::create_host_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
+                                        VkBuffer& buffer, VkDeviceMemory& memory, void** mapped) {
+    VkBufferCreateInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    info.size = size;
+    info.usage = usage;
+    info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(backend_->device(), &info, nullptr, &buffer) != VK_SUCCESS) {
+        buffer = VK_NULL_HANDLE;
+        return false;
+    }
+    VkMemoryRequirements mr;
+    vkGetBufferMemoryRequirements(backend_->device(), buffer, &mr);
+    VkMemoryAllocateInfo mai{};
+    mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mai.allocationSize = mr.size;
+    mai.memoryTypeIndex = memory_manager_->find_memory_type(
+        mr.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (vkAllocateMemory(backend_->device(), &mai, nullptr, &memory) != VK_SUCCESS) {
+        vkDestroyBuffer(backend_->device(), buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        memory = VK_NULL_HANDLE;
+        return false;
+    }
+    vkBindBufferMemory(backend_->device(), buffer, memory, 0);
+    if (mapped) vkMapMemory(backend_->device(), memory, 0, size, 0, mapped);
+    return true;
+}
 
-    if (vkCreateDescriptorPool(backend_->device(), &pool_info, nullptr, &descriptor_pool_) != VK_SUCCESS) {
-        std::cerr << "Failed to create descriptor pool" << std::endl;
+namespace {
+// The context the calling thread used last, tagged with its launcher's id. Launcher ids
+// are never reused, so a stale cache from a destroyed launcher cannot alias a new one
+// allocated at the same address.
+thread_local uint64_t t_cached_owner = 0;
+thread_local void* t_cached_context = nullptr;
+}  // namespace
+
+KernelLauncher::ThreadContext& KernelLauncher::ctx() {
+    if (t_cached_owner == instance_id_) return *static_cast<ThreadContext*>(t_cached_context);
+
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    auto& slot = contexts_[std::this_thread::get_id()];
+    if (!slot) {
+        slot = create_context();
+        t_thread_exit.launchers.push_back(instance_id_);
     }
-    
+    t_cached_owner = instance_id_;
+    t_cached_context = slot.get();
+    return *slot;
+}
+
+KernelLauncher::ThreadContext* KernelLauncher::find_ctx() {
+    if (t_cached_owner == instance_id_) return static_cast<ThreadContext*>(t_cached_context);
+    std::lock_guard<std::mutex> lock(contexts_mutex_);
+    auto it = contexts_.find(std::this_thread::get_id());
+    return it == contexts_.end() ? nullptr : it->second.get();
+}
+
+void KernelLauncher::release_thread() {
+    ThreadContext* context = find_ctx();
+    if (!context) return;
+    if (backend_ && backend_->device() != VK_NULL_HANDLE) {
+        if (context->capture) abort_capture("the capturing thread exited");
+        sync();
+        // Unlike at shutdown, the arena is still up: give graph scratch back to it.
+        for (auto& graph : context->graphs)
+            for (auto& fn : graph->releases) fn();
+        destroy_context(*context);
+    }
+    {
+        std::lock_guard<std::mutex> lock(contexts_mutex_);
+        contexts_.erase(std::this_thread::get_id());
+    }
+    auto& launchers = t_thread_exit.launchers;
+    launchers.erase(std::remove(launchers.begin(), launchers.end(), instance_id_), launchers.end());
+    if (t_cached_owner == instance_id_) {
+        t_cached_owner = 0;
+        t_cached_context = nullptr;
+    }
+}
+
+std::unique_ptr<KernelLauncher::ThreadContext> KernelLauncher::create_context() {
+    auto context = std::make_unique<ThreadContext>();
+    context->queue = backend_->acquire_queue();
+
+    // Descriptor pool for the cached sets. Only the pooled fallback needs one (push
+    // descriptors allocate nothing); single-use sets come from per-frame pools.
+    if (!push_descriptor_) {
+        context->descriptor_pool = create_descriptor_pool(kCachePoolSets);
+        if (context->descriptor_pool == VK_NULL_HANDLE) {
+            std::cerr << "Failed to create descriptor pool" << std::endl;
+        }
+    }
+
     // Create command pool
     VkCommandPoolCreateInfo cmd_pool_info{};
     cmd_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     cmd_pool_info.queueFamilyIndex = backend_->compute_queue_family();
     cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     
-    if (vkCreateCommandPool(backend_->device(), &cmd_pool_info, nullptr, &command_pool_) != VK_SUCCESS) {
+    if (vkCreateCommandPool(backend_->device(), &cmd_pool_info, nullptr, &context->command_pool) != VK_SUCCESS) {
         std::cerr << "Failed to create command pool" << std::endl;
     }
     
-    // Allocate command buffer
+    // Allocate one command buffer per frame of the in-flight ring
+    VkCommandBuffer cmds[kFramesInFlight] = {};
     VkCommandBufferAllocateInfo alloc_info{};
     alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    alloc_info.commandPool = command_pool_;
+    alloc_info.commandPool = context->command_pool;
     alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    alloc_info.commandBufferCount = 1;
-    
-    vkAllocateCommandBuffers(backend_->device(), &alloc_info, &command_buffer_);
+    alloc_info.commandBufferCount = kFramesInFlight;
     
-    // Create fence for synchronization
-    VkFenceCreateInfo fence_info{};
-    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    vkAllocateCommandBuffers(backend_->device(), &alloc_info, cmds);
     
-    vkCreateFence(backend_->device(), &fence_info, nullptr, &fence_);
+    for (uint32_t i = 0; i < kFramesInFlight; ++i) {
+        Frame& frame = context->frames[i];
+        frame.cmd = cmds[i];
+
+        // Per-frame fence, created signaled so a never-used frame needs no wait
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        vkCreateFence(backend_->device(), &fence_info, nullptr, &frame.fence);
+
+        // Host-visible readback slot for scalar results (reduce value, compaction kept
+        // count). Primitives copy just those bytes here instead of migrating the arena.
+        // One per frame, so an in-flight result is not overwritten by the next launch.
+        VkBufferCreateInfo slot_info{};
+        slot_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        slot_info.size = kResultSlotSize;
+        slot_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        slot_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        if (vkCreateBuffer(backend_->device(), &slot_info, nullptr, &frame.result_buffer) == VK_SUCCESS) {
+            VkMemoryRequirements mr;
+            vkGetBufferMemoryRequirements(backend_->device(), frame.result_buffer, &mr);
+            VkMemoryAllocateInfo mai{};
+            mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            mai.allocationSize = mr.size;
+            mai.memoryTypeIndex = memory_manager_->find_memory_type(
+                mr.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            if (vkAllocateMemory(backend_->device(), &mai, nullptr, &frame.result_memory) == VK_SUCCESS) {
+                vkBindBufferMemory(backend_->device(), frame.result_buffer, frame.result_memory, 0);
+                vkMapMemory(backend_->device(), frame.result_memory, 0, kResultSlotSize, 0, &frame.result_mapped);
+            }
+        }
+        if (!frame.result_mapped) {
+            std::cerr << "Failed to create result readback slot" << std::endl;
+        }
+    }
+
+    // Capture ring: one persistently mapped uniform buffer, a kCaptureSegmentSize
+    // segment per frame (see upload_captures).
+    if (!create_host_buffer(kCaptureSegmentSize * kFramesInFlight, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                            context->capture_buffer, context->capture_memory, &context->capture_mapped)) {
+        std::cerr << "Failed to create capture ring" << std::endl;
+    }
+    context->capture_alignment = std::max<VkDeviceSize>(backend_->limits().minUniformBufferOffsetAlignment, 16);
+
+    // Timestamp queries for the tuner's samples (see begin_timing).
+    if (tuner_) {
+        VkQueryPoolCreateInfo query_info{};
+        query_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        query_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        query_info.queryCount = 2 * kFrameTimings * kFramesInFlight;
+        if (vkCreateQueryPool(backend_->device(), &query_info, nullptr, &context->timing_pool) != VK_SUCCESS) {
+            std::cerr << "Failed to create timestamp query pool" << std::endl;
+            context->timing_pool = VK_NULL_HANDLE;
+        }
+    }
+
+    return context;
 }
 
-void KernelLauncher::retire_transient_buffers() {
-    if (transient_buffers_.empty()) return;
-    // These scratch buffers are referenced by cached descriptor sets, so they live
-    // for the launcher's lifetime and are reclaimed here at teardown. If the device
-    // has already been torn down (static-destruction order), just drop the handles.
-    if (!backend_ || backend_->device() == VK_NULL_HANDLE) {
-        transient_buffers_.clear();
-        return;
+void KernelLauncher::destroy_context(ThreadContext& context) {
+    VkDevice device = backend_->device();
+    // Deferred launches that were never flushed still run: submit the open recording.
+    if (context.deferred_launches > 0) {
+        Frame& open = context.frames[context.frame_index];
+        vkEndCommandBuffer(open.cmd);
+        open.pending = backend_->submit(context.queue, open.cmd, open.fence, &open.timeline) == VK_SUCCESS;
+        context.deferred_launches = 0;
+    }
+    // Let in-flight frames finish, then drop their resources. Pending completion
+    // callbacks are discarded: the host objects they would write may already be gone.
+    for (Frame& frame : context.frames) {
+        if (frame.pending && frame.timeline != 0) backend_->wait_timeline(context.queue, frame.timeline);
+        else if (frame.pending) vkWaitForFences(device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+        frame.pending = false;
+        if (frame.high) backend_->high_priority_retired();
+        frame.high = false;
+        frame.completions.clear();
+        frame.timings.clear();
+        destroy_buffers(frame.transients);
+        for (VkDescriptorPool pool : frame.pools) vkDestroyDescriptorPool(device, pool, nullptr);
+        frame.pools.clear();
+        if (frame.fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, frame.fence, nullptr);
+        }
+        if (frame.result_buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, frame.result_buffer, nullptr);
+        }
+        if (frame.result_memory != VK_NULL_HANDLE) {
+            vkFreeMemory(device, frame.result_memory, nullptr);
+        }
+    }
+    // Graphs still alive: their replays were frames above. Their scratch is not freed
+    // (like the discarded callbacks, the arena may already be gone).
+    for (auto& graph : context.graphs) destroy_graph_resources(*graph);
+    context.graphs.clear();
+    context.replays.clear();
+    context.capture = nullptr;
+    if (context.capture_buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, context.capture_buffer, nullptr);
+    }
+    if (context.capture_memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, context.capture_memory, nullptr);
     }
-    vkDeviceWaitIdle(backend_->device());
-    for (auto& [buf, mem] : transient_buffers_) {
+    context.descriptor_cache.clear();
+
+    if (context.command_pool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, context.command_pool, nullptr);
+    }
+    if (context.descriptor_pool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, context.descriptor_pool, nullptr);
+    }
+    if (context.timing_pool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(device, context.timing_pool, nullptr);
+    }
+    backend_->release_queue(context.queue);
+}
+
+void KernelLauncher::destroy_buffers(std::vector<std::pair<VkBuffer, VkDeviceMemory>>& buffers) {
+    for (auto& [buf, mem] : buffers) {
         if (buf != VK_NULL_HANDLE) vkDestroyBuffer(backend_->device(), buf, nullptr);
         if (mem != VK_NULL_HANDLE) vkFreeMemory(backend_->device(), mem, nullptr);
     }
-    transient_buffers_.clear();
+    buffers.clear();
+}
+
+VkDescriptorBufferInfo KernelLauncher::upload_captures(const void* data, size_t size) {
+    // The block is bound as a whole uniform; keep the old 64-byte minimum (zero padded)
+    // so a shader block slightly larger than the host struct still reads defined bytes.
+    const VkDeviceSize range = std::max<VkDeviceSize>(size, kZeroUniformSize);
+    ThreadContext& c = ctx();
+    if (Graph* graph = c.capture) {
+        // A captured block outlives any frame: give it its own uniform, which is also
+        // what set_graph_captures() patches.
+        VkBuffer buf = VK_NULL_HANDLE;
+        VkDeviceMemory mem = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        if (!create_host_buffer(range, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, buf, mem, &mapped)) {
+            abort_capture("could not create a captures uniform buffer");
+            return zero_uniform();
+        }
+        std::memcpy(mapped, data, size);
+        std::memset(static_cast<char*>(mapped) + size, 0, range - size);
+        graph->buffers.emplace_back(buf, mem);
+        graph->params.push_back({mapped, static_cast<size_t>(range)});
+        return VkDescriptorBufferInfo{buf, 0, range};
+    }
+    Frame& frame = acquire_frame();
+    const VkDeviceSize offset =
+        (frame.capture_used + c.capture_alignment - 1) / c.capture_alignment * c.capture_alignment;
+    if (c.capture_mapped && offset + range <= kCaptureSegmentSize) {
+        const VkDeviceSize at = static_cast<VkDeviceSize>(c.frame_index) * kCaptureSegmentSize + offset;
+        char* dst = static_cast<char*>(c.capture_mapped) + at;
+        std::memcpy(dst, data, size);
+        std::memset(dst + size, 0, range - size);
+        frame.capture_used = offset + range;
+        return VkDescriptorBufferInfo{c.capture_buffer, at, range};
+    }
+
+    // Segment full (or the block is larger than a segment): a dedicated buffer owned
+    // by the frame.
+    VkBuffer buf = VK_NULL_HANDLE;
+    VkDeviceMemory mem = VK_NULL_HANDLE;
+    void* mapped = nullptr;
+    if (!create_host_buffer(range, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, buf, mem, &mapped)) {
+        std::cerr << "Failed to create captures uniform buffer" << std::endl;
+        return zero_uniform();
+    }
+    std::memcpy(mapped, data, size);
+    std::memset(static_cast<char*>(mapped) + size, 0, range - size);
+    frame.transients.emplace_back(buf, mem);
+    return VkDescriptorBufferInfo{buf, 0, range};
+}
+
+VkDescriptorPool KernelLauncher::create_descriptor_pool(uint32_t max_sets) {
+    // Sized for the shared layout: up to 3 storage bindings and one uniform per set.
+    // No FREE_DESCRIPTOR_SET flag: sets are never freed one by one, so allocation can
+    // be a plain bump and a reset returns everything at once.
+    VkDescriptorPoolSize pool_sizes[2];
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[0].descriptorCount = 3 * max_sets;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    pool_sizes[1].descriptorCount = max_sets;
+
+    VkDescriptorPoolCreateInfo pool_info{};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = 2;
+    pool_info.pPoolSizes = pool_sizes;
+    pool_info.maxSets = max_sets;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(backend_->device(), &pool_info, nullptr, &pool) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+    return pool;
+}
+
+VkDescriptorSet KernelLauncher::allocate_frame_set(VkDescriptorSetLayout layout) {
+    ThreadContext& c = ctx();
+    Frame& frame = c.frames[c.frame_index];
+    std::vector<VkDescriptorPool>& pools = c.capture ? c.capture->pools : frame.pools;
+    uint32_t& pool_index = c.capture ? c.capture->pool_index : frame.pool_index;
+    VkDescriptorSetAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &layout;
+    for (;;) {
+        if (pool_index == pools.size()) {
+            // Every pool of this frame is full (or it has none yet): add one. Pools are
+            // kept across retires, so a steady workload stops creating them.
+            VkDescriptorPool pool = create_descriptor_pool(kFramePoolSets);
+            if (pool == VK_NULL_HANDLE) return VK_NULL_HANDLE;
+            pools.push_back(pool);
+        }
+        alloc_info.descriptorPool = pools[pool_index];
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &set) == VK_SUCCESS) return set;
+        ++pool_index;  // exhausted (OUT_OF_POOL_MEMORY / FRAGMENTED_POOL): next pool
+    }
+}
+
+bool KernelLauncher::bind_descriptors(const PipelineData& pipeline_data, const Bindings& bindings,
+                                      const CacheKey* key) {
+    ThreadContext& c = ctx();
+    VkWriteDescriptorSet writes[4]{};
+    uint32_t n = 0;
+    for (uint32_t binding = 0; binding < 4; ++binding) {
+        if (!(bindings.mask & (1u << binding))) continue;
+        writes[n].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[n].dstBinding = binding;
+        writes[n].descriptorType = pipeline_data.binding_types[binding];
+        writes[n].descriptorCount = 1;
+        writes[n].pBufferInfo = &bindings.buffers[binding];
+        ++n;
+    }
+    if (HazardTracker* hazards = recording_hazards()) {
+        VkDescriptorBufferInfo storage[4];
+        uint32_t ranges = 0, written = 0;
+        const uint32_t reads = pipeline_data.readonly_bindings | bindings.reads;
+        for (uint32_t binding : {0u, 1u, 3u}) {
+            if (!(bindings.mask & (1u << binding))) continue;
+            if (!(reads & (1u << binding))) written |= 1u << ranges;
+            storage[ranges++] = bindings.buffers[binding];
+        }
+        track_hazards(*hazards, c.command_buffer, storage, ranges, written);
+    }
+
+    // Push descriptors: the writes are recorded into the command buffer itself
+    // (dstSet is ignored) and stay bound for the following dispatches.
+    if (pipeline_data.push_descriptor) {
+        push_descriptor_(c.command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                         pipeline_data.layout, 0, n, writes);
+        return true;
+    }
+
+    // Pooled fallback. A cached set is bound as-is: it may be referenced by a
+    // submission still in flight, so it is written once (at allocation) and never
+    // updated afterwards. Once the cache pool is full, new keys just get a
+    // single-use set.
+    VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+    bool fresh = false;  // newly allocated cache entry, still to be written
+    if (key) {
+        auto hit = c.descriptor_cache.find(*key);
+        if (hit != c.descriptor_cache.end()) {
+            descriptor_set = hit->second;
+        } else if (c.descriptor_pool != VK_NULL_HANDLE) {
+            VkDescriptorSetAllocateInfo alloc_info{};
+            alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            alloc_info.descriptorPool = c.descriptor_pool;
+            alloc_info.descriptorSetCount = 1;
+            alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
+            if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) == VK_SUCCESS) {
+                c.descriptor_cache[*key] = descriptor_set;
+                fresh = true;
+            }
+        }
+        if (descriptor_set != VK_NULL_HANDLE && !fresh) {  // cache hit
+            vkCmdBindDescriptorSets(c.command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                    pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
+            return true;
+        }
+    }
+    if (descriptor_set == VK_NULL_HANDLE) {
+        descriptor_set = allocate_frame_set(pipeline_data.descriptor_set_layout);
+        if (descriptor_set == VK_NULL_HANDLE) {
+            if (c.capture) abort_capture("could not allocate a descriptor set");
+            else c.frames[c.frame_index].record_failed = true;  // submit_commands drops the recording
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < n; ++i) writes[i].dstSet = descriptor_set;
+    vkUpdateDescriptorSets(backend_->device(), n, writes, 0, nullptr);
+    vkCmdBindDescriptorSets(c.command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
+    return true;
 }
 
 KernelLauncher::~KernelLauncher() {
-    retire_transient_buffers();
+    {
+        // Wait out threads that are releasing their context here as they exit.
+        std::unique_lock<std::mutex> lock(live_launchers_mutex());
+        live_launchers_released().wait(lock, [this] {
+            return live_launchers()[instance_id_].releasing == 0;
+        });
+        live_launchers().erase(instance_id_);
+    }
+    // If the device has already been torn down (static-destruction order), just drop
+    // the handles.
+    if (!backend_ || backend_->device() == VK_NULL_HANDLE) {
+        std::cout << "[KernelLauncher] Destructor: device already destroyed" << std::endl;
+        return;
+    }
+    for (auto& [thread, context] : contexts_) destroy_context(*context);
+    contexts_.clear();
     std::cout << "[KernelLauncher] Destructor: Cleaning up " << pipelines_.size() << " pipelines" << std::endl;
 
-    // Clean up pipelines
-    for (auto& [hash, pipeline_data] : pipelines_) {
+    // Clean up pipelines (handles held elsewhere keep only the struct alive)
+    for (const PipelineHandle& handle : pipelines_) {
+        const PipelineData& pipeline_data = *handle;
         try {
             if (pipeline_data.pipeline != VK_NULL_HANDLE) {
                 vkDestroyPipeline(backend_->device(), pipeline_data.pipeline, nullptr);
             }
+            for (const PipelineData::Variant& variant : pipeline_data.variants) {
+                if (variant.pipeline != pipeline_data.pipeline)  // the default-size variant is `pipeline`
+                    vkDestroyPipeline(backend_->device(), variant.pipeline, nullptr);
+            }
             if (pipeline_data.layout != VK_NULL_HANDLE) {
                 vkDestroyPipelineLayout(backend_->device(), pipeline_data.layout, nullptr);
             }
@@ -142,30 +753,28 @@ KernelLauncher::~KernelLauncher() {
 
     pipelines_.clear();
 
-    if (fence_ != VK_NULL_HANDLE) {
-        vkDestroyFence(backend_->device(), fence_, nullptr);
+    if (zero_uniform_buffer_ != VK_NULL_HANDLE) {
+        vkDestroyBuffer(backend_->device(), zero_uniform_buffer_, nullptr);
     }
-
-    if (command_pool_ != VK_NULL_HANDLE) {
-        vkDestroyCommandPool(backend_->device(), command_pool_, nullptr);
-    }
-
-    if (descriptor_pool_ != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(backend_->device(), descriptor_pool_, nullptr);
+    if (zero_uniform_memory_ != VK_NULL_HANDLE) {
+        vkFreeMemory(backend_->device(), zero_uniform_memory_, nullptr);
     }
 
     std::cout << "[KernelLauncher] Destructor: Cleanup complete" << std::endl;
 }
 
-bool KernelLauncher::load_kernel(const std::string& name, const uint32_t* spirv_code, size_t spirv_size) {
+PipelineHandle KernelLauncher::load_kernel(const std::string& name, const uint32_t* spirv_code, size_t spirv_size,
+                                           uint32_t flags) {
     // Debug: Dump SPIR-V header only (first 10 words) to avoid output buffer issues
-    std::cerr << "SPIR-V Dump for " << name << " (" << spirv_size << " bytes):" << std::endl;
-    std::cerr << "  Header (first 10 words): ";
-    for (size_t i = 0; i < std::min<size_t>(spirv_size / 4, 10); ++i) {
-        std::cerr << "0x" << std::hex << spirv_code[i] << std::dec;
-        if (i + 1 < std::min<size_t>(spirv_size / 4, 10)) std::cerr << " ";
+    if (std::getenv("PARALLAX_DEBUG")) {
+        std::cerr << "SPIR-V Dump for " << name << " (" << spirv_size << " bytes):" << std::endl;
+        std::cerr << "  Header (first 10 words): ";
+        for (size_t i = 0; i < std::min<size_t>(spirv_size / 4, 10); ++i) {
+            std::cerr << "0x" << std::hex << spirv_code[i] << std::dec;
+            if (i + 1 < std::min<size_t>(spirv_size / 4, 10)) std::cerr << " ";
+        }
+        std::cerr << std::endl;
     }
-    std::cerr << std::endl;
 
     // Create shader module
     VkShaderModuleCreateInfo create_info{};
@@ -176,7 +785,7 @@ bool KernelLauncher::load_kernel(const std::string& name, const uint32_t* spirv_
     VkShaderModule shader_module;
     if (vkCreateShaderModule(backend_->device(), &create_info, nullptr, &shader_module) != VK_SUCCESS) {
         std::cerr << "Failed to create shader module for " << name << std::endl;
-        return false;
+        return nullptr;
     }
     
     // Create descriptor set layout
@@ -185,50 +794,63 @@ bool KernelLauncher::load_kernel(const std::string& name, const uint32_t* spirv_
     // Binding 3: Storage buffer for a third array (compaction scatter: positions).
     //   Existing kernels never declare/access binding 3, so per the Vulkan spec they
     //   need not write it — the 2-storage dispatch paths are unaffected (additive).
+    //   An address-ABI kernel has no descriptor set at all (see PipelineData::address_abi).
+    auto data = std::make_shared<PipelineData>();
+    data->name = name;
+    const ShaderInfo shader = parse_shader(spirv_code, spirv_size / 4);
+    data->address_abi = shader.address_abi();
     std::vector<VkDescriptorSetLayoutBinding> bindings(4);
-    for (int i = 0; i < 2; ++i) {
+    for (uint32_t i = 0; i < 4; ++i) {
         bindings[i].binding = i;
-        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorType = data->binding_types[i];
         bindings[i].descriptorCount = 1;
         bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     }
-    // Binding 2: Uniform buffer for captures
-    bindings[2].binding = 2;
-    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    bindings[2].descriptorCount = 1;
-    bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    // Binding 3: third storage buffer (compaction only).
-    bindings[3].binding = 3;
-    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    bindings[3].descriptorCount = 1;
-    bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 
     VkDescriptorSetLayoutCreateInfo layout_info{};
     layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
     layout_info.pBindings = bindings.data();
-
-    VkDescriptorSetLayout descriptor_set_layout;
-    if (vkCreateDescriptorSetLayout(backend_->device(), &layout_info, nullptr, &descriptor_set_layout) != VK_SUCCESS) {
+    // Push-descriptor layouts take their bindings from the command buffer and cannot
+    // back pool-allocated sets; the launcher uses one mode or the other throughout.
+    data->push_descriptor = push_descriptor_ != nullptr;
+    if (data->push_descriptor) layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+
+    VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+    if (!data->address_abi &&
+        vkCreateDescriptorSetLayout(backend_->device(), &layout_info, nullptr, &descriptor_set_layout) != VK_SUCCESS) {
         std::cerr << "Failed to create descriptor set layout" << std::endl;
         vkDestroyShaderModule(backend_->device(), shader_module, nullptr);
-        return false;
+        return nullptr;
     }
 
     // Create pipeline layout with push constants. Layout (matches the compiler's
-    // setup_push_constants): { uint count @0, uint64 host_base @8, uint64 dev_base
-    // @16 }. Ordinary kernels only read count@0; pointer-chasing kernels also read
-    // the arena bases to relocate stored host pointers. The range is sized for the
-    // superset so a single pipeline layout serves both.
+    // setup_push_constants): { uint64 count @0, uint64 host_base @8, uint64 dev_base
+    // @16, uint64 base @24 }. Ordinary kernels only read count@0; pointer-chasing
+    // kernels also read the arena bases to relocate stored host pointers, and
+    // index-dependent ones the chunk base. The range is sized for the superset so a
+    // single pipeline layout serves all of them. An address-ABI kernel's range also
+    // holds its array addresses, and an inline-captures kernel's its captures, in as
+    // much of the device's push-constant size as kMaxPushSize allows.
     VkPushConstantRange push_constant{};
     push_constant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     push_constant.offset = 0;
-    push_constant.size = 24;
+    push_constant.size = kPushHeaderSize;
+    const uint32_t room = std::min(backend_->limits().maxPushConstantsSize, kMaxPushSize) - kPushHeaderSize;
+    if (data->address_abi) {
+        data->address_args = room / static_cast<uint32_t>(sizeof(VkDeviceAddress));
+        push_constant.size += data->address_args * static_cast<uint32_t>(sizeof(VkDeviceAddress));
+    }
+    if (flags & kInlineCaptures) {
+        data->inline_captures = room;  // shared with the addresses of an address-ABI kernel
+        push_constant.size = kPushHeaderSize + room;
+    }
+    data->push_size = push_constant.size;
     
     VkPipelineLayoutCreateInfo pipeline_layout_info{};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipeline_layout_info.setLayoutCount = 1;
-    pipeline_layout_info.pSetLayouts = &descriptor_set_layout;
+    pipeline_layout_info.setLayoutCount = data->address_abi ? 0 : 1;
+    pipeline_layout_info.pSetLayouts = data->address_abi ? nullptr : &descriptor_set_layout;
     pipeline_layout_info.pushConstantRangeCount = 1;
     pipeline_layout_info.pPushConstantRanges = &push_constant;
     
@@ -237,7 +859,7 @@ bool KernelLauncher::load_kernel(const std::string& name, const uint32_t* spirv_
         std::cerr << "Failed to create pipeline layout" << std::endl;
         vkDestroyDescriptorSetLayout(backend_->device(), descriptor_set_layout, nullptr);
         vkDestroyShaderModule(backend_->device(), shader_module, nullptr);
-        return false;
+        return nullptr;
     }
     
     // Create compute pipeline
@@ -258,31 +880,57 @@ bool KernelLauncher::load_kernel(const std::string& name, const uint32_t* spirv_
         vkDestroyPipelineLayout(backend_->device(), pipeline_layout, nullptr);
         vkDestroyDescriptorSetLayout(backend_->device(), descriptor_set_layout, nullptr);
         vkDestroyShaderModule(backend_->device(), shader_module, nullptr);
-        return false;
+        return nullptr;
     }
     
+    // Workgroup-size variants: a kernel whose size is a specialization constant is
+    // built once per candidate size for the tuner to choose between (plan_dispatch).
+    data->spirv_hash = hash_spirv(spirv_code, spirv_size);
+    data->workgroup_size = shader.size;
+    data->grid_2d = shader.grid_2d;
+    data->readonly_bindings = shader.readonly_bindings;
+    if (shader.spec_id >= 0 && !workgroup_candidates_.empty()) {
+        for (uint32_t size : workgroup_candidates_) {
+            if (size == shader.size) {
+                data->variants.push_back({size, pipeline});
+                continue;
+            }
+            VkSpecializationMapEntry entry{static_cast<uint32_t>(shader.spec_id), 0, sizeof(uint32_t)};
+            VkSpecializationInfo specialization{1, &entry, sizeof(uint32_t), &size};
+            VkComputePipelineCreateInfo variant_info = pipeline_info;
+            variant_info.stage.pSpecializationInfo = &specialization;
+            VkPipeline variant = VK_NULL_HANDLE;
+            if (vkCreateComputePipelines(backend_->device(), VK_NULL_HANDLE, 1, &variant_info, nullptr, &variant) == VK_SUCCESS)
+                data->variants.push_back({size, variant});
+            else
+                std::cerr << "Failed to create " << name << " variant for workgroup size " << size << std::endl;
+        }
+    }
+
     // Store pipeline data
-    PipelineData data;
-    data.pipeline = pipeline;
-    data.layout = pipeline_layout;
-    data.descriptor_set_layout = descriptor_set_layout;
-    data.shader_module = shader_module;
+    data->pipeline = pipeline;
+    data->layout = pipeline_layout;
+    data->descriptor_set_layout = descriptor_set_layout;
+    data->shader_module = shader_module;
     
-    pipelines_[name] = data;
+    {
+        std::lock_guard<std::mutex> lock(pipelines_mutex_);
+        pipelines_.push_back(data);
+    }
     
     std::cout << "Loaded kernel: " << name << std::endl;
-    return true;
+    return data;
 }
 
-bool KernelLauncher::launch(const std::string& kernel_name, void* buffer, size_t count, float multiplier, size_t elem_size) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) {
-        std::cerr << "Kernel not found: " << kernel_name << std::endl;
+bool KernelLauncher::launch(const PipelineHandle& kernel, void* buffer, size_t count, float multiplier, size_t elem_size) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto it = kernel.get();
+    if (!it) {
+        std::cerr << "Kernel not loaded" << std::endl;
         return false;
     }
 
-    auto& pipeline_data = it->second;
+    auto& pipeline_data = *it;
 
     // Phase 2c: if the data is arena-backed (e.g. via allocation interposition),
     // bind the arena buffer directly at the allocation's offset (zero-copy unified
@@ -314,148 +962,427 @@ bool KernelLauncher::launch(const std::string& kernel_name, void* buffer, size_t
         memory_manager_->sync_before_kernel(buffer);
     }
 
-    // Check descriptor cache
-    CacheKey key{pipeline_data.descriptor_set_layout, buffer};
-    VkDescriptorSet descriptor_set;
-    if (descriptor_cache_.count(key)) {
-        descriptor_set = descriptor_cache_[key];
-    } else {
-        // Allocate descriptor set
-        VkDescriptorSetAllocateInfo alloc_info{};
-        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool = descriptor_pool_;
-        alloc_info.descriptorSetCount = 1;
-        alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-        
-        if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-            std::cerr << "Failed to allocate descriptor set" << std::endl;
+    // Binding 0: the data buffer; binding 2: the shared zero uniform (this kernel reads
+    // no captures). The pooled fallback caches the set per (layout, buffer, range).
+    Bindings bindings;
+    bindings.set(0, {vk_buffer, data_offset, data_range});
+    bindings.set(2, zero_uniform());
+    CacheKey key{pipeline_data.descriptor_set_layout, buffer, data_range};
+
+    // Wait for previous operations if any, then record and submit.
+    begin_commands();
+
+    // Push constants: count + arena bases (for pointer-chasing relocation). A range
+    // larger than one dispatch covers runs as chunks of the data array.
+    ChunkStrides strides;
+    strides.per_element[0] = elem_size;
+    record_chunked(pipeline_data, bindings, strides, count, &key);
+
+    // NOTE: sync_after_kernel is not done here to avoid a host-device roundtrip.
+    // The caller downloads a registered (non-arena) buffer once the work completed.
+    return submit_commands("[launch]");
+}
+
+void KernelLauncher::sync() {
+    flush();
+    retire_through(ctx().submit_serial, true);
+}
+
+void KernelLauncher::flush() {
+    ThreadContext& c = ctx();
+    if (c.deferred_launches == 0) return;
+    c.deferred_launches = 0;
+    submit_recording("[flush]");
+}
+
+void KernelLauncher::set_priority(LaunchPriority priority) {
+    ThreadContext& c = ctx();
+    if (priority == c.priority) return;
+    if (c.capture) {
+        std::cerr << "[priority] cannot change priority while capturing a graph" << std::endl;
+        return;
+    }
+    // The thread's frames retire in order on one queue: finish them before moving.
+    sync();
+    backend_->release_queue(c.queue);
+    c.priority = priority;
+    c.queue = backend_->acquire_queue(priority);
+}
+
+bool KernelLauncher::retire_through(uint64_t serial, bool block) {
+    ThreadContext& c = ctx();
+    if (block && backend_->timeline(c.queue)) {
+        // One wait for the newest frame in range: the timeline reaching its value
+        // means every earlier submission has completed too.
+        uint64_t value = 0;
+        for (const Frame& frame : c.frames)
+            if (frame.pending && frame.serial <= serial) value = std::max(value, frame.timeline);
+        if (value != 0) backend_->wait_timeline(c.queue, value);
+    }
+    for (;;) {
+        // Oldest pending frame within range: frames retire in submission order, so
+        // completion callbacks run in that order too.
+        Frame* oldest = nullptr;
+        for (Frame& frame : c.frames) {
+            if (frame.pending && frame.serial <= serial && (!oldest || frame.serial < oldest->serial))
+                oldest = &frame;
+        }
+        if (!oldest) return true;
+        if (oldest->timeline != 0) {
+            if (!block && !backend_->timeline_reached(c.queue, oldest->timeline)) return false;
+        } else if (block) {
+            backend_->wait_fence(oldest->fence);
+        } else if (vkGetFenceStatus(backend_->device(), oldest->fence) != VK_SUCCESS) {
             return false;
         }
+        oldest->pending = false;
+        if (oldest->high) backend_->high_priority_retired();
+        oldest->high = false;
+        if (oldest->serial > c.complete_serial) c.complete_serial = oldest->serial;
+        // Swap first: a callback may queue another one (it then attaches to a newer
+        // frame, or runs immediately when nothing is in flight).
+        std::vector<std::function<void()>> ready;
+        ready.swap(oldest->completions);
+        for (auto& fn : ready) fn();
+        release_frame(*oldest);
     }
-    
-    // Update descriptor set
-    VkDescriptorBufferInfo buffer_info{};
-    buffer_info.buffer = vk_buffer;
-    buffer_info.offset = data_offset;
-    buffer_info.range = data_range;
-
-    // Create a small dummy uniform buffer for captures (empty for now)
-    VkBuffer dummy_uniform_buffer = VK_NULL_HANDLE;
-    VkDeviceMemory dummy_uniform_memory = VK_NULL_HANDLE;
-    VkBufferCreateInfo uniform_buf_info{};
-    uniform_buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    uniform_buf_info.size = 64; // Small buffer for captures
-    uniform_buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    uniform_buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    vkCreateBuffer(backend_->device(), &uniform_buf_info, nullptr, &dummy_uniform_buffer);
-
-    VkMemoryRequirements mem_reqs;
-    vkGetBufferMemoryRequirements(backend_->device(), dummy_uniform_buffer, &mem_reqs);
-
-    VkMemoryAllocateInfo alloc{};
-    alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    alloc.allocationSize = mem_reqs.size;
-    alloc.memoryTypeIndex = memory_manager_->find_memory_type(mem_reqs.memoryTypeBits,
-                                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    vkAllocateMemory(backend_->device(), &alloc, nullptr, &dummy_uniform_memory);
-    vkBindBufferMemory(backend_->device(), dummy_uniform_buffer, dummy_uniform_memory, 0);
-
-    VkDescriptorBufferInfo captures_buffer_info{};
-    captures_buffer_info.buffer = dummy_uniform_buffer;
-    captures_buffer_info.offset = 0;
-    captures_buffer_info.range = VK_WHOLE_SIZE;
-
-    // Write both storage buffer (binding 0) and uniform buffer (binding 2)
-    std::vector<VkWriteDescriptorSet> writes(2);
-    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[0].dstSet = descriptor_set;
-    writes[0].dstBinding = 0;
-    writes[0].dstArrayElement = 0;
-    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    writes[0].descriptorCount = 1;
-    writes[0].pBufferInfo = &buffer_info;
-
-    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[1].dstSet = descriptor_set;
-    writes[1].dstBinding = 2; // Captures uniform buffer
-    writes[1].dstArrayElement = 0;
-    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[1].descriptorCount = 1;
-    writes[1].pBufferInfo = &captures_buffer_info;
-
-    vkUpdateDescriptorSets(backend_->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
-    descriptor_cache_[key] = descriptor_set;
-
-    transient_buffers_.emplace_back(dummy_uniform_buffer, dummy_uniform_memory);
-    
-    // Wait for previous operations if any
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    
-    // Record command buffer
-    vkResetCommandBuffer(command_buffer_, 0);
-    
+}
+
+void KernelLauncher::release_frame(Frame& frame) {
+    collect_timings(frame, true);
+    destroy_buffers(frame.transients);
+    // Every single-use set of the frame goes back at once; untouched pools stay as-is.
+    for (uint32_t i = 0; i < frame.pools.size() && i <= frame.pool_index; ++i)
+        vkResetDescriptorPool(backend_->device(), frame.pools[i], 0);
+    frame.pool_index = 0;
+    frame.capture_used = 0;  // its capture segment is free again
+    frame.result_used = false;
+}
+
+KernelLauncher::Frame& KernelLauncher::acquire_frame() {
+    ThreadContext& c = ctx();
+    if (!c.frame_acquired) {
+        c.frame_index = (c.frame_index + 1) % kFramesInFlight;
+        Frame& frame = c.frames[c.frame_index];
+        if (frame.pending) retire_through(frame.serial, true);
+        release_frame(frame);  // leftovers of a recording that never submitted
+        c.frame_acquired = true;
+    }
+    return c.frames[c.frame_index];
+}
+
+bool KernelLauncher::is_complete(uint64_t serial) {
+    if (serial <= ctx().complete_serial) return true;
+    flush();  // the serial may be that of the open deferred recording
+    return retire_through(serial, false);
+}
+
+void KernelLauncher::wait_for(uint64_t serial) {
+    flush();
+    if (serial > ctx().complete_serial) retire_through(serial, true);
+}
+
+void KernelLauncher::when_complete(std::function<void()> fn) {
+    ThreadContext& c = ctx();
+    // A captured launch completes on every replay of its graph.
+    if (Graph* graph = c.capture) {
+        graph->epilogues.push_back(std::move(fn));
+        return;
+    }
+    // Deferred launches complete with the frame they are being recorded into.
+    if (c.deferred_launches > 0) {
+        c.frames[c.frame_index].completions.push_back(std::move(fn));
+        return;
+    }
+    // The queue executes in order, so the newest pending frame completing implies
+    // every earlier submission has completed as well.
+    Frame* newest = nullptr;
+    for (Frame& frame : c.frames) {
+        if (frame.pending && (!newest || frame.serial > newest->serial)) newest = &frame;
+    }
+    if (!newest) {
+        fn();
+        return;
+    }
+    newest->completions.push_back(std::move(fn));
+}
+
+void KernelLauncher::when_retired(std::function<void()> fn) {
+    if (Graph* graph = ctx().capture) {
+        graph->releases.push_back(std::move(fn));
+        return;
+    }
+    when_complete(std::move(fn));
+}
+
+bool KernelLauncher::begin_capture() {
+    flush();  // deferred launches run before, not inside, the graph
+    if (ctx().capture) {
+        std::cerr << "[graph] a capture is already in progress on this thread" << std::endl;
+        return false;
+    }
+    return open_graph(0);
+}
+
+bool KernelLauncher::open_graph(VkCommandBufferUsageFlags usage) {
+    ThreadContext& c = ctx();
+    auto graph = std::make_unique<Graph>();
+    graph->owner = &c;
+    VkCommandBufferAllocateInfo alloc_info{};
+    alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    alloc_info.commandPool = c.command_pool;
+    alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    alloc_info.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(backend_->device(), &alloc_info, &graph->cmd) != VK_SUCCESS) {
+        std::cerr << "[graph] Failed to allocate command buffer" << std::endl;
+        return false;
+    }
+    // Not one-time: the recording is submitted once per replay.
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-    
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
+    begin_info.flags = usage;
+    graph->simultaneous = (usage & VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT) != 0;
+    vkBeginCommandBuffer(graph->cmd, &begin_info);
+    if (!backend_->timeline()) record_submission_barrier(graph->cmd);
+    c.capture = graph.get();
+    c.graphs.push_back(std::move(graph));
+    return true;
+}
 
-    // Push constants: count + arena bases (for pointer-chasing relocation).
-    PushBlock push = make_push_block(count);
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+KernelLauncher::Graph* KernelLauncher::end_capture() {
+    Graph* graph = ctx().capture;
+    if (!graph) {
+        std::cerr << "[graph] no capture in progress on this thread" << std::endl;
+        return nullptr;
+    }
+    if (graph->nodes == 0 && !graph->failed) std::cerr << "[graph] nothing was captured" << std::endl;
+    const uint32_t nodes = graph->nodes, barriers = graph->hazards.barriers;
+    graph = close_graph();
+    if (graph)
+        std::cout << "[graph] captured " << nodes << " launches with " << barriers
+                  << " inter-launch barriers" << std::endl;
+    return graph;
+}
 
-    // Dispatch compute shader (256 threads per workgroup)
-    uint32_t workgroup_count = (count + 255) / 256;
-    vkCmdDispatch(command_buffer_, workgroup_count, 1, 1);
-    
-    vkEndCommandBuffer(command_buffer_);
-    
-    // Submit command buffer
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
-    
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "Failed to submit command buffer" << std::endl;
+KernelLauncher::Graph* KernelLauncher::close_graph() {
+    ThreadContext& c = ctx();
+    Graph* graph = c.capture;
+    c.capture = nullptr;
+    vkEndCommandBuffer(graph->cmd);
+    if (graph->failed || graph->nodes == 0) {
+        destroy_graph(graph);
+        return nullptr;
+    }
+    graph->hazards.reset();
+    return graph;
+}
+
+bool KernelLauncher::capturing() {
+    ThreadContext* c = find_ctx();
+    return c && c->capture;
+}
+
+void KernelLauncher::abort_capture(const char* reason) {
+    ThreadContext* c = find_ctx();
+    if (!c || !c->capture || c->capture->failed) return;
+    std::cerr << "[graph] capture aborted: " << reason << std::endl;
+    c->capture->failed = true;
+}
+
+KernelLauncher::HazardTracker* KernelLauncher::recording_hazards() {
+    ThreadContext& c = ctx();
+    if (c.capture) return &c.capture->hazards;
+    // A launch made with deferral off still appends to an open recording.
+    return c.deferred || c.deferred_launches > 0 ? &c.hazards : nullptr;
+}
+
+void KernelLauncher::track_hazards(HazardTracker& tracker, VkCommandBuffer cmd, const VkDescriptorBufferInfo* ranges,
+                                   uint32_t count, uint32_t writes) {
+    bool conflict = false;
+    for (uint32_t i = 0; i < count; ++i) {
+        const VkDeviceSize begin = ranges[i].offset;
+        const VkDeviceSize end = ranges[i].range == VK_WHOLE_SIZE ? ~VkDeviceSize(0) : begin + ranges[i].range;
+        const bool write = (writes >> i) & 1;
+        for (const HazardTracker::Range& h : tracker.done) {
+            // Read-after-read is the only overlap that needs no ordering.
+            if (h.buffer == ranges[i].buffer && begin < h.end && h.begin < end && (write || h.write))
+                conflict = true;
+        }
+        tracker.node.push_back({ranges[i].buffer, begin, end, write});
+    }
+    if (conflict) {
+        // Covers transfer accesses too (a readback copy of an earlier launch).
+        record_submission_barrier(cmd);
+        tracker.done.clear();
+        ++tracker.barriers;
+    }
+}
+
+bool KernelLauncher::launch_graph(Graph* graph) {
+    ThreadContext& c = ctx();
+    if (!graph || graph->owner != &c) {
+        std::cerr << "[graph] a graph is replayed by the thread that captured it" << std::endl;
         return false;
     }
-    
-    fence_signaled_ = false;
-    
-    // NOTE: sync_after_kernel is removed to avoid host-device roundtrip.
-    // User must call sync() explicitly if they want to access the buffer.
-    
+    if (c.capture) {
+        std::cerr << "[graph] cannot replay a graph while capturing" << std::endl;
+        return false;
+    }
+    flush();  // the graph submits through the frame a deferred recording holds
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around the whole graph (no-op on UMA)
+    // Unless the command buffer is SIMULTANEOUS_USE, its previous replay must be done.
+    if (!graph->simultaneous) wait_for(graph->serial);
+    Frame& frame = acquire_frame();
+    vkResetFences(backend_->device(), 1, &frame.fence);
+    if (!queue_submit(graph->cmd, "[graph]")) return false;
+    graph->serial = frame.serial;
+    for (const auto& fn : graph->epilogues) when_complete(fn);
     return true;
 }
 
-void KernelLauncher::sync() {
-    if (!fence_signaled_) {
-        vkWaitForFences(backend_->device(), 1, &fence_, VK_TRUE, UINT64_MAX);
-        fence_signaled_ = true;
+bool KernelLauncher::set_graph_captures(Graph* graph, size_t index, const void* data, size_t size) {
+    if (!graph || graph->owner != &ctx()) {
+        std::cerr << "[graph] a graph is patched by the thread that captured it" << std::endl;
+        return false;
+    }
+    if (index >= graph->params.size() || size > graph->params[index].size) {
+        std::cerr << "[graph] no captures block " << index << " of " << size << " bytes" << std::endl;
+        return false;
+    }
+    // The block is read in place by the recording: never rewrite it under a replay.
+    wait_for(graph->serial);
+    std::memcpy(graph->params[index].mapped, data, size);
+    std::memset(static_cast<char*>(graph->params[index].mapped) + size, 0, graph->params[index].size - size);
+    return true;
+}
+
+void KernelLauncher::destroy_graph(Graph* graph) {
+    if (!graph) return;
+    ThreadContext& c = ctx();
+    if (graph->owner != &c) {
+        std::cerr << "[graph] a graph is destroyed by the thread that captured it" << std::endl;
+        return;
+    }
+    wait_for(graph->serial);
+    for (auto& fn : graph->releases) fn();
+    destroy_graph_resources(*graph);
+    if (c.capture == graph) c.capture = nullptr;
+    for (auto it = c.graphs.begin(); it != c.graphs.end(); ++it) {
+        if (it->get() == graph) {
+            c.graphs.erase(it);
+            break;
+        }
+    }
+}
+
+void KernelLauncher::destroy_graph_resources(Graph& graph) {
+    VkDevice device = backend_->device();
+    if (graph.cmd != VK_NULL_HANDLE) vkFreeCommandBuffers(device, graph.owner->command_pool, 1, &graph.cmd);
+    graph.cmd = VK_NULL_HANDLE;
+    for (VkDescriptorPool pool : graph.pools) vkDestroyDescriptorPool(device, pool, nullptr);
+    graph.pools.clear();
+    destroy_buffers(graph.buffers);
+}
+
+bool KernelLauncher::replay_launch(const PipelineHandle& kernel, ReplayKey key, size_t elem_size,
+                                   const void* captures, size_t capture_size,
+                                   const std::function<bool()>& record) {
+    ThreadContext& c = ctx();
+    // A deferred launch joins the open recording instead, and one being captured
+    // belongs to the caller's graph.
+    if (!replay_cache_ || c.deferred || c.capture) return record();
+    if (!captures) capture_size = 0;
+    if (key.pipeline->inline_captures > 0) {
+        const auto* bytes = static_cast<const unsigned char*>(captures);
+        key.inline_captures.assign(bytes, bytes + capture_size);
+    } else {
+        key.capture_size = capture_size;
+    }
+
+    ReplayEntry* entry = nullptr;
+    for (ReplayEntry& e : c.replays) {
+        if (e.key == key) { entry = &e; break; }
     }
+    if (!entry) {
+        if (c.replays.size() >= kReplayCacheEntries) {
+            auto lru = std::min_element(c.replays.begin(), c.replays.end(),
+                                        [](const ReplayEntry& a, const ReplayEntry& b) { return a.last_use < b.last_use; });
+            if (lru->graph) destroy_graph(lru->graph);  // waits for its last replay
+            c.replays.erase(lru);
+        }
+        c.replays.push_back({std::move(key), kernel});
+        entry = &c.replays.back();
+    }
+    entry->last_use = ++c.replay_clock;
+
+    if (!entry->graph) {
+        // Most launches never repeat: record only the second one, and only once its
+        // workgroup size is final (a recording keeps the size it was made at).
+        if (++entry->launches < 2 || !tuning_settled(*kernel, entry->key.count, elem_size)) return record();
+        flush();
+        if (!open_graph(VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT)) return record();
+        const bool recorded = record();
+        Graph* graph = close_graph();
+        if (!recorded || !graph) return record();  // not capturable: run it as usual
+        entry->graph = graph;
+        const auto* bytes = static_cast<const unsigned char*>(captures);
+        entry->captures.assign(bytes, bytes + capture_size);
+        return launch_graph(graph);
+    }
+    // Only a uniform captures block is patchable (it is the graph's only parameter).
+    if (!entry->graph->params.empty() &&
+        (capture_size != entry->captures.size() ||
+         (capture_size > 0 && std::memcmp(captures, entry->captures.data(), capture_size) != 0))) {
+        if (!set_graph_captures(entry->graph, 0, captures, capture_size)) return record();
+        const auto* bytes = static_cast<const unsigned char*>(captures);
+        entry->captures.assign(bytes, bytes + capture_size);
+    }
+    return launch_graph(entry->graph);
+}
+
+bool KernelLauncher::tuning_settled(const PipelineData& pipeline_data, size_t count, size_t elem_size) const {
+    if (!tuner_ || pipeline_data.variants.empty() || count > dispatch_limit(pipeline_data, elem_size)) return true;
+    return tuner_->tuned(pipeline_data.spirv_hash, WorkgroupTuner::bucket_of(count));
 }
 
-bool KernelLauncher::launch(const std::string& kernel_name, void* buffer, size_t count, size_t elem_size) {
+bool KernelLauncher::launch(const PipelineHandle& kernel, void* buffer, size_t count, size_t elem_size) {
     // Reuse specific implementation with dummy multiplier
-    return launch(kernel_name, buffer, count, 1.0f, elem_size);
+    return launch(kernel, buffer, count, 1.0f, elem_size);
+}
+
+bool KernelLauncher::launch_transform(const PipelineHandle& kernel, void* in_buffer, void* out_buffer, size_t count, size_t elem_size, size_t out_elem_size, void* captures, size_t capture_size) {
+    auto record = [&] {
+        return record_transform(kernel, in_buffer, out_buffer, count, elem_size, out_elem_size, captures, capture_size);
+    };
+    UnifiedArena* arena = get_global_arena();
+    if (!kernel || count == 0 || !arena || !in_buffer || !out_buffer || !arena->contains(in_buffer) ||
+        !arena->contains(out_buffer))
+        return record();
+    const size_t out_size = out_elem_size ? out_elem_size : elem_size;
+    ReplayKey key;
+    key.pipeline = kernel.get();
+    key.offsets[0] = arena->offset_of(in_buffer);
+    key.sizes[0] = count * elem_size;
+    key.offsets[1] = arena->offset_of(out_buffer);
+    key.sizes[1] = count * out_size;
+    key.count = count;
+    return replay_launch(kernel, std::move(key), std::max(elem_size, out_size), captures, capture_size, record);
 }
 
-bool KernelLauncher::launch_transform(const std::string& kernel_name, void* in_buffer, void* out_buffer, size_t count, size_t elem_size, size_t out_elem_size, void* captures, size_t capture_size) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) {
-        std::cerr << "Kernel not found: " << kernel_name << std::endl;
+bool KernelLauncher::record_transform(const PipelineHandle& kernel, void* in_buffer, void* out_buffer, size_t count,
+                                      size_t elem_size, size_t out_elem_size, void* captures, size_t capture_size) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto it = kernel.get();
+    if (!it) {
+        std::cerr << "Kernel not loaded" << std::endl;
         return false;
     }
 
-    auto& pipeline_data = it->second;
+    auto& pipeline_data = *it;
+    const bool has_captures = (captures != nullptr && capture_size > 0);
+    const bool inline_abi = pipeline_data.inline_captures > 0;
+    if (inline_abi && !check_inline_captures("[transform]", pipeline_data, has_captures ? capture_size : 0))
+        return false;
 
     // Resolve in/out buffers. Arena-backed (e.g. the funnel's staged buffers) bind the
     // arena VkBuffer zero-copy at their offset; plain pointers are auto-registered. The
@@ -493,159 +1420,65 @@ bool KernelLauncher::launch_transform(const std::string& kernel_name, void* in_b
         return false;
     }
     
-    // Check descriptor cache (multi-buffer key is complex, for MVP we use a simple combination)
-    // Actually, for transform we have 2 buffers. We'll use the out_buffer as the key part for now
-    // or better, a combined key. For now, let's just use the out_buffer since layout is fixed.
-    // Captures vary per call, so a capturing transform bypasses the descriptor cache
-    // (a cached set keyed by out_buffer would rebind stale capture bytes).
-    const bool has_captures = (captures != nullptr && capture_size > 0);
+    // Bindings: in@0, out@1, and the uniform@2 captures block for a capturing transform
+    // op (a block of this thread's capture ring) or the shared zero uniform for a
+    // captureless one. The pooled fallback caches a captureless set keyed by out_buffer
+    // (the layout is fixed); captures vary per call, so a capturing set is never cached
+    // (it would rebind stale capture bytes). Inline captures travel in the push block,
+    // so binding 2 stays empty and the set is cacheable either way.
+    Bindings bindings;
+    bindings.set(0, {vk_in, in_off, in_size ? static_cast<VkDeviceSize>(in_size) : VK_WHOLE_SIZE});
+    bindings.set(1, {vk_out, out_off, out_size ? static_cast<VkDeviceSize>(out_size) : VK_WHOLE_SIZE});
+    bindings.reads = 1u << 0;  // a transform only reads its input
+    if (!inline_abi) bindings.set(2, has_captures ? upload_captures(captures, capture_size) : zero_uniform());
     CacheKey key{pipeline_data.descriptor_set_layout, out_buffer};
-    VkDescriptorSet descriptor_set;
-    if (!has_captures && descriptor_cache_.count(key)) {
-        descriptor_set = descriptor_cache_[key];
-    } else {
-        // Allocate descriptor set
-        VkDescriptorSetAllocateInfo alloc_info{};
-        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool = descriptor_pool_;
-        alloc_info.descriptorSetCount = 1;
-        alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-        
-        if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-            std::cerr << "Failed to allocate descriptor set" << std::endl;
-            return false;
-        }
-        
-        // Update descriptor set (2 storage buffers + 1 uniform buffer for captures)
-        std::vector<VkDescriptorBufferInfo> buffer_infos(2);
-        buffer_infos[0].buffer = vk_in;
-        buffer_infos[0].offset = in_off;
-        buffer_infos[0].range = in_size ? static_cast<VkDeviceSize>(in_size) : VK_WHOLE_SIZE;
-
-        buffer_infos[1].buffer = vk_out;
-        buffer_infos[1].offset = out_off;
-        buffer_infos[1].range = out_size ? static_cast<VkDeviceSize>(out_size) : VK_WHOLE_SIZE;
-
-        // Binding 2 uniform: the captures block for a capturing transform op, or a zero
-        // dummy for a captureless one. Same layout as launch_with_captures' scalar path.
-        VkBuffer dummy_uniform_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory dummy_uniform_memory = VK_NULL_HANDLE;
-        VkBufferCreateInfo uniform_buf_info{};
-        uniform_buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        uniform_buf_info.size = std::max<size_t>(capture_size, 64);
-        uniform_buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        uniform_buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        vkCreateBuffer(backend_->device(), &uniform_buf_info, nullptr, &dummy_uniform_buffer);
-
-        VkMemoryRequirements mem_reqs;
-        vkGetBufferMemoryRequirements(backend_->device(), dummy_uniform_buffer, &mem_reqs);
-
-        VkMemoryAllocateInfo alloc{};
-        alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc.allocationSize = mem_reqs.size;
-        alloc.memoryTypeIndex = memory_manager_->find_memory_type(mem_reqs.memoryTypeBits,
-                                                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        vkAllocateMemory(backend_->device(), &alloc, nullptr, &dummy_uniform_memory);
-        vkBindBufferMemory(backend_->device(), dummy_uniform_buffer, dummy_uniform_memory, 0);
-
-        if (has_captures) {
-            void* mapped_data = nullptr;
-            vkMapMemory(backend_->device(), dummy_uniform_memory, 0, capture_size, 0, &mapped_data);
-            std::memcpy(mapped_data, captures, capture_size);
-            vkUnmapMemory(backend_->device(), dummy_uniform_memory);
-        }
-
-        VkDescriptorBufferInfo captures_buffer_info{};
-        captures_buffer_info.buffer = dummy_uniform_buffer;
-        captures_buffer_info.offset = 0;
-        captures_buffer_info.range = VK_WHOLE_SIZE;
-
-        std::vector<VkWriteDescriptorSet> writes(3);
-        for (int i = 0; i < 2; ++i) {
-            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            writes[i].dstSet = descriptor_set;
-            writes[i].dstBinding = i;
-            writes[i].dstArrayElement = 0;
-            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            writes[i].descriptorCount = 1;
-            writes[i].pBufferInfo = &buffer_infos[i];
-        }
-
-        // Binding 2: Captures uniform buffer
-        writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[2].dstSet = descriptor_set;
-        writes[2].dstBinding = 2;
-        writes[2].dstArrayElement = 0;
-        writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        writes[2].descriptorCount = 1;
-        writes[2].pBufferInfo = &captures_buffer_info;
-
-        vkUpdateDescriptorSets(backend_->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
-        if (!has_captures) descriptor_cache_[key] = descriptor_set;  // captures vary per call
-
-        transient_buffers_.emplace_back(dummy_uniform_buffer, dummy_uniform_memory);
-    }
-
-    // Wait for previous operations if any
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-
-    // Record command buffer (same logic as launch)
-    vkResetCommandBuffer(command_buffer_, 0);
-    
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-    
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
 
+    // Record and submit (same logic as launch).
+    begin_commands();
     // Push constants: count + arena bases (for pointer-chasing relocation).
-    PushBlock push = make_push_block(count);
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
-
-    // Dispatch
-    uint32_t workgroup_count = (count + 255) / 256;
-    vkCmdDispatch(command_buffer_, workgroup_count, 1, 1);
-    
-    vkEndCommandBuffer(command_buffer_);
-    
-    // Submit
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
-    
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "Failed to submit command buffer" << std::endl;
-        return false;
-    }
-    
-    fence_signaled_ = false;
-    return true;
+    ChunkStrides strides;
+    strides.per_element[0] = elem_size;
+    strides.per_element[1] = out_elem_size;
+    if (inline_abi)
+        record_chunked(pipeline_data, bindings, strides, count, &key, captures, has_captures ? capture_size : 0);
+    else
+        record_chunked(pipeline_data, bindings, strides, count, has_captures ? nullptr : &key);
+    return submit_commands("[transform]");
 }
 
 // NEW V2: Launch kernel with captured parameters (for function objects)
 bool KernelLauncher::launch_with_captures(
-    const std::string& kernel_name,
+    const PipelineHandle& kernel,
     void* buffer,
     size_t count,
     void* captures,
     size_t capture_size,
     size_t elem_size) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
+    auto record = [&] { return record_with_captures(kernel, buffer, count, captures, capture_size, elem_size); };
+    UnifiedArena* arena = get_global_arena();
+    if (!kernel || count == 0 || !arena || !buffer || !arena->contains(buffer)) return record();
+    ReplayKey key;
+    key.pipeline = kernel.get();
+    key.offsets[0] = arena->offset_of(buffer);
+    key.sizes[0] = count * elem_size;
+    key.count = count;
+    return replay_launch(kernel, std::move(key), elem_size, captures, capture_size, record);
+}
+
+bool KernelLauncher::record_with_captures(const PipelineHandle& kernel, void* buffer, size_t count,
+                                          void* captures, size_t capture_size, size_t elem_size) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
 
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) {
-        std::cerr << "Kernel not found: " << kernel_name << std::endl;
+    auto it = kernel.get();
+    if (!it) {
+        std::cerr << "Kernel not loaded" << std::endl;
         return false;
     }
 
-    auto& pipeline_data = it->second;
+    auto& pipeline_data = *it;
+    const bool inline_abi = pipeline_data.inline_captures > 0;
+    if (captures == nullptr) capture_size = 0;
+    if (inline_abi && !check_inline_captures("[captures]", pipeline_data, capture_size)) return false;
 
     // Resolve the data buffer the SAME way launch() does: arena-backed data (e.g. the
     // funnel's staged buffer) binds the arena VkBuffer zero-copy at its offset; a plain
@@ -669,254 +1502,538 @@ bool KernelLauncher::launch_with_captures(
             std::cerr << "Invalid buffer" << std::endl;
             return false;
         }
-        memory_manager_->sync_before_kernel(buffer);
+        memory_manager_->sync_before_kernel(buffer);
+    }
+    if (data_range == 0) data_range = VK_WHOLE_SIZE;
+
+    // NOTE: the old "decomposed vector" heuristic that byte-scanned the capture struct
+    // for {T* data, size_t size} pairs and bound them at binding 1 has been removed. It
+    // guessed pointer/size fields with magic thresholds and a hardcoded element-size,
+    // which could bind the wrong buffer or misread a scalar capture's bytes as a pointer
+    // — a silent-wrong-result hazard. The compiler now carries a captured POINTER in the
+    // uniform@2 block as a uint64 host address and RELOCATES it in-kernel (gpu = dev_base
+    // + p - host_base, via PhysicalStorageBuffer), exactly like element pointer-chasing —
+    // so no capturing kernel needs a binding-1 buffer. The captures block below is the
+    // opaque memcpy'd closure (pointers-as-u64, scalars, and by-value POD structs).
+
+    // Binding 0: Main buffer (storage buffer). Bind at the arena offset (zero-copy)
+    // when arena-backed; offset 0 otherwise.
+    // (Binding 1 for a captured buffer is no longer written — see the note above.)
+    // Binding 2: the captures block, carved from this thread's capture ring. Captures
+    // vary per call, so the bindings are never cached. An inline-captures kernel gets
+    // them in the push block instead, and nothing at binding 2.
+    Bindings bindings;
+    bindings.set(0, {vk_buffer, data_offset, data_range});
+    if (!inline_abi)
+        bindings.set(2, capture_size > 0 ? upload_captures(captures, capture_size) : zero_uniform());
+
+    // Record and submit. Push constants: count + arena bases (for pointer-chasing
+    // relocation), then any inline captures.
+    begin_commands();
+    ChunkStrides strides;
+    strides.per_element[0] = elem_size;
+    if (inline_abi) record_chunked(pipeline_data, bindings, strides, count, nullptr, captures, capture_size);
+    else record_chunked(pipeline_data, bindings, strides, count);
+    return submit_commands("[captures]");
+}
+
+bool KernelLauncher::launch_batch(const BatchLaunch* launches, size_t n) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    if (n == 0) return true;
+    UnifiedArena* arena = get_global_arena();
+
+    // Resolve every buffer first (arena-backed ones bind the arena zero-copy, plain
+    // pointers are auto-registered), so a bad entry fails before anything is recorded.
+    auto resolve = [&](void* p, VkDeviceSize size, VkDescriptorBufferInfo& info) -> bool {
+        if (arena && arena->contains(p)) { info = {arena->buffer(), arena->offset_of(p), size}; return true; }
+        VkBuffer reg = memory_manager_->get_buffer(p);
+        if (reg == VK_NULL_HANDLE) { memory_manager_->register_external_buffer(p, size); reg = memory_manager_->get_buffer(p); }
+        if (reg == VK_NULL_HANDLE) return false;
+        memory_manager_->sync_before_kernel(p);
+        info = {reg, 0, VK_WHOLE_SIZE};
+        return true;
+    };
+    std::vector<Bindings> bindings(n);
+    std::vector<ChunkStrides> strides(n);
+    for (size_t i = 0; i < n; ++i) {
+        const BatchLaunch& l = launches[i];
+        if (!l.kernel || !l.in) {
+            std::cerr << "[batch] launch " << i << " has no " << (l.kernel ? "buffer" : "kernel") << std::endl;
+            return false;
+        }
+        const size_t capture_size = l.captures ? l.capture_size : 0;
+        if (l.kernel->inline_captures > 0 && !check_inline_captures("[batch]", *l.kernel, capture_size)) return false;
+        if (l.count == 0) continue;
+        const size_t out_elem_size = l.out_elem_size ? l.out_elem_size : l.in_elem_size;
+        VkDescriptorBufferInfo in_info, out_info;
+        if (!resolve(l.in, l.count * l.in_elem_size, in_info) ||
+            (l.out && !resolve(l.out, l.count * out_elem_size, out_info))) {
+            std::cerr << "[batch] launch " << i << ": invalid buffer" << std::endl;
+            return false;
+        }
+        bindings[i].set(0, in_info);
+        strides[i].per_element[0] = l.in_elem_size;
+        if (l.out) {
+            bindings[i].set(1, out_info);
+            bindings[i].reads = 1u << 0;  // a transform, not an in-place map
+            strides[i].per_element[1] = out_elem_size;
+        }
     }
-    if (data_range == 0) data_range = VK_WHOLE_SIZE;
 
-    // Check descriptor cache
-    CacheKey key{pipeline_data.descriptor_set_layout, buffer};
-    VkDescriptorSet descriptor_set;
-    if (descriptor_cache_.count(key)) {
-        descriptor_set = descriptor_cache_[key];
-    } else {
-        // Allocate descriptor set
-        VkDescriptorSetAllocateInfo alloc_info{};
-        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool = descriptor_pool_;
-        alloc_info.descriptorSetCount = 1;
-        alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-
-        if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-            std::cerr << "Failed to allocate descriptor set" << std::endl;
-            return false;
+    begin_commands();
+    size_t since_barrier = 0;  // launches recorded since the last barrier
+    for (size_t i = 0; i < n; ++i) {
+        const BatchLaunch& l = launches[i];
+        const uint64_t recent = since_barrier >= 64 ? ~0ull : (1ull << since_barrier) - 1;
+        if (l.depends & recent) {
+            record_compute_barrier(ctx().command_buffer);
+            since_barrier = 0;
         }
-
-        // NOTE: the old "decomposed vector" heuristic that byte-scanned the capture struct
-        // for {T* data, size_t size} pairs and bound them at binding 1 has been removed. It
-        // guessed pointer/size fields with magic thresholds and a hardcoded element-size,
-        // which could bind the wrong buffer or misread a scalar capture's bytes as a pointer
-        // — a silent-wrong-result hazard. The compiler now carries a captured POINTER in the
-        // uniform@2 block as a uint64 host address and RELOCATES it in-kernel (gpu = dev_base
-        // + p - host_base, via PhysicalStorageBuffer), exactly like element pointer-chasing —
-        // so no capturing kernel needs a binding-1 buffer. The captures block below is the
-        // opaque memcpy'd closure (pointers-as-u64, scalars, and by-value POD structs).
-
-        // Prepare descriptor writes
-        std::vector<VkWriteDescriptorSet> writes;
-        std::vector<VkDescriptorBufferInfo> buffer_infos;
-
-        // Reserve space to prevent reallocation (important! pointers must remain valid)
-        buffer_infos.reserve(3);
-        writes.reserve(3);
-
-        // Binding 0: Main buffer (storage buffer). Bind at the arena offset (zero-copy)
-        // when arena-backed; offset 0 otherwise.
-        buffer_infos.push_back({vk_buffer, data_offset, data_range});
-        VkWriteDescriptorSet write0{};
-        write0.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write0.dstSet = descriptor_set;
-        write0.dstBinding = 0;
-        write0.dstArrayElement = 0;
-        write0.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        write0.descriptorCount = 1;
-        write0.pBufferInfo = &buffer_infos[0];
-        writes.push_back(write0);
-
-        // (Binding 1 for a captured buffer is no longer written — see the note above.)
-
-        // Binding 2: Captures uniform buffer
-        VkBuffer captures_uniform_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory captures_uniform_memory = VK_NULL_HANDLE;
-
-        VkBufferCreateInfo uniform_buf_info{};
-        uniform_buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        uniform_buf_info.size = std::max<size_t>(capture_size, 64); // At least 64 bytes
-        uniform_buf_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        uniform_buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-        vkCreateBuffer(backend_->device(), &uniform_buf_info, nullptr, &captures_uniform_buffer);
-
-        VkMemoryRequirements mem_reqs;
-        vkGetBufferMemoryRequirements(backend_->device(), captures_uniform_buffer, &mem_reqs);
-
-        VkMemoryAllocateInfo mem_alloc{};
-        mem_alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        mem_alloc.allocationSize = mem_reqs.size;
-        mem_alloc.memoryTypeIndex = memory_manager_->find_memory_type(mem_reqs.memoryTypeBits,
-                                                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        vkAllocateMemory(backend_->device(), &mem_alloc, nullptr, &captures_uniform_memory);
-        vkBindBufferMemory(backend_->device(), captures_uniform_buffer, captures_uniform_memory, 0);
-
-        // Copy captures data to uniform buffer
-        if (capture_size > 0 && captures != nullptr) {
-            void* mapped_data;
-            vkMapMemory(backend_->device(), captures_uniform_memory, 0, capture_size, 0, &mapped_data);
-            std::memcpy(mapped_data, captures, capture_size);
-            vkUnmapMemory(backend_->device(), captures_uniform_memory);
+        ++since_barrier;
+        if (l.count == 0) continue;
+        const PipelineData& pipeline_data = *l.kernel;
+        const size_t capture_size = l.captures ? l.capture_size : 0;
+        if (pipeline_data.inline_captures > 0) {
+            record_chunked(pipeline_data, bindings[i], strides[i], l.count, nullptr, l.captures, capture_size);
+        } else {
+            bindings[i].set(2, capture_size > 0 ? upload_captures(l.captures, capture_size) : zero_uniform());
+            record_chunked(pipeline_data, bindings[i], strides[i], l.count);
         }
-
-        buffer_infos.push_back({captures_uniform_buffer, 0, VK_WHOLE_SIZE});
-        VkWriteDescriptorSet write2{};
-        write2.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write2.dstSet = descriptor_set;
-        write2.dstBinding = 2;
-        write2.dstArrayElement = 0;
-        write2.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        write2.descriptorCount = 1;
-        write2.pBufferInfo = &buffer_infos[buffer_infos.size() - 1];  // Use correct index
-        writes.push_back(write2);
-
-        vkUpdateDescriptorSets(backend_->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
-        descriptor_cache_[key] = descriptor_set;
-
-        transient_buffers_.emplace_back(captures_uniform_buffer, captures_uniform_memory);
     }
+    return submit_commands("[batch]");
+}
 
-    // Wait for previous operations if any
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
+bool KernelLauncher::launch_addressed(const PipelineHandle& kernel, size_t count, void* const* arrays,
+                                      const size_t* elem_sizes, size_t num_arrays) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto it = kernel.get();
+    if (!it) { std::cerr << "[addressed] kernel not found" << std::endl; return false; }
+    const PipelineData& pipeline_data = *it;
+    if (!pipeline_data.address_abi) {
+        std::cerr << "[addressed] " << pipeline_data.name << " binds descriptors; use the other launch paths" << std::endl;
+        return false;
+    }
+    if (num_arrays > pipeline_data.address_args) {
+        std::cerr << "[addressed] " << num_arrays << " arrays; the push block holds "
+                  << pipeline_data.address_args << " addresses on this device" << std::endl;
+        return false;
+    }
+    if (count == 0) return true;
+    UnifiedArena* arena = get_global_arena();
+    if (!arena || !arena->valid()) { std::cerr << "[addressed] requires arena" << std::endl; return false; }
 
-    // Record command buffer
-    vkResetCommandBuffer(command_buffer_, 0);
+    // Every array as an arena range (the address is taken from its offset).
+    std::vector<VkDescriptorBufferInfo> ranges(num_arrays);
+    for (size_t i = 0; i < num_arrays; ++i) {
+        if (!arrays[i] || !arena->contains(arrays[i])) {
+            std::cerr << "[addressed] array " << i << " is not arena-resident" << std::endl;
+            return false;
+        }
+        ranges[i] = {arena->buffer(), arena->offset_of(arrays[i]), VK_WHOLE_SIZE};
+    }
+
+    // No binding ranges bound a dispatch here, only the grid and 32-bit indices: a
+    // larger launch runs in chunks, each addressing its per-element arrays at the
+    // chunk (arrays with elem_sizes[i] == 0 are passed unchanged).
+    const size_t limit = dispatch_limit(pipeline_data, 0);
+    const Dispatch plan = plan_dispatch(pipeline_data, std::min(count, limit), nullptr, count <= limit);
+    std::vector<VkDescriptorBufferInfo> chunk(ranges);
+    begin_commands();
+    for (size_t base = 0; ; base += limit) {
+        const size_t n = std::min(limit, count - base);
+        for (size_t i = 0; i < num_arrays; ++i) {
+            if (elem_sizes[i] == 0) continue;
+            chunk[i].offset = ranges[i].offset + base * elem_sizes[i];
+            chunk[i].range = n * elem_sizes[i];
+        }
+        Dispatch dispatch = plan;
+        dispatch.groups = static_cast<uint32_t>((n + plan.size - 1) / plan.size);
+        shape_grid(dispatch);
+        PushBlock push = make_push_block(n, base);
+        vkCmdBindPipeline(ctx().command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, dispatch.pipeline);
+        if (!push_addresses(pipeline_data, &push, sizeof(push), chunk.data(), static_cast<uint32_t>(num_arrays))) {
+            if (dispatch.sample) tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+            break;  // the recording is dropped
+        }
+        record_grid(dispatch);
+        if (base + n >= count) break;
+    }
+    return submit_commands("[addressed]");
+}
 
+void KernelLauncher::begin_commands() {
+    ThreadContext& c = ctx();
+    if (Graph* graph = c.capture) {
+        // Next node of the graph being captured: it records into the graph's command
+        // buffer, and the previous node's ranges become hazards for it.
+        graph->hazards.next_node();
+        c.command_buffer = graph->cmd;
+        return;
+    }
+    if (c.deferred_launches > 0) {
+        // Append to the open deferred recording, ordered after the launches before it
+        // only where it conflicts with them (track_hazards records the barrier).
+        c.hazards.next_node();
+        return;
+    }
+    c.hazards.reset();
+    // Take the next frame (waits only if it is still in flight), then start a fresh
+    // one-time recording into its command buffer.
+    Frame& frame = acquire_frame();
+    vkResetFences(backend_->device(), 1, &frame.fence);
+    c.command_buffer = frame.cmd;
+    vkResetCommandBuffer(frame.cmd, 0);
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(frame.cmd, &begin_info);
+    // The previous submission (this thread's or another's) may still be executing:
+    // order this one's shader and transfer accesses after everything submitted before
+    // it on the queue (the timeline wait does that when there is one).
+    if (!backend_->timeline()) record_submission_barrier(frame.cmd);
+}
 
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
+bool KernelLauncher::submit_commands(const char* tag) {
+    ThreadContext& c = ctx();
+    if (Graph* graph = c.capture) {
+        // The node stays in the graph's recording; nothing runs until a replay.
+        ++graph->nodes;
+        return !graph->failed;
+    }
+    if (c.deferred && !c.frames[c.frame_index].record_failed &&
+        ++c.deferred_launches < kMaxDeferredLaunches) {
+        return true;  // stays open for the next launch; a flush submits it
+    }
+    c.deferred_launches = 0;
+    return submit_recording(tag);
+}
 
-    // Push constants: count + arena bases (for pointer-chasing relocation).
-    PushBlock push = make_push_block(count);
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout,
-                      VK_SHADER_STAGE_COMPUTE_BIT, 0,
-                      sizeof(push), &push);
+bool KernelLauncher::submit_recording(const char* tag) {
+    ThreadContext& c = ctx();
+    Frame& frame = c.frames[c.frame_index];
+    vkEndCommandBuffer(frame.cmd);
+    if (frame.record_failed) {
+        // The pooled fallback could not get a descriptor set mid-recording: drop the
+        // recording (the frame stays reserved for the next one).
+        std::cerr << tag << " Failed to allocate descriptor set" << std::endl;
+        frame.record_failed = false;
+        collect_timings(frame, false);
+        release_frame(frame);
+        return false;
+    }
+    if (c.arena_staged) {
+        // Migrate the staged recording's results back once, ahead of its epilogues. A
+        // launch still recording stays staged: what it appends next migrates back too.
+        UnifiedArena* arena = get_global_arena();
+        frame.completions.insert(frame.completions.begin(), [arena] { migrate_from_device(arena); });
+        c.arena_staged = g_arena_sync_depth > 0;
+    }
+    return queue_submit(frame.cmd, tag);
+}
 
-    // Dispatch compute shader (256 threads per workgroup)
-    uint32_t workgroup_count = (count + 255) / 256;
-    vkCmdDispatch(command_buffer_, workgroup_count, 1, 1);
+bool KernelLauncher::queue_submit(VkCommandBuffer cmd, const char* tag) {
+    ThreadContext& c = ctx();
+    Frame& frame = c.frames[c.frame_index];
+    // With a timeline the frame completes at its value and its fence stays unused.
+    VkFence fence = backend_->timeline(c.queue) ? VK_NULL_HANDLE : frame.fence;
+    if (backend_->submit(c.queue, cmd, fence, &frame.timeline) != VK_SUCCESS) {
+        std::cerr << tag << " Failed to submit command buffer" << std::endl;
+        return false;
+    }
+    frame.pending = true;
+    frame.high = c.priority == LaunchPriority::High;
+    if (frame.high) backend_->high_priority_submitted();
+    frame.serial = ++c.submit_serial;
+    c.frame_acquired = false;
+    if (!c.async) sync();
+    return true;
+}
 
-    vkEndCommandBuffer(command_buffer_);
+void KernelLauncher::record_dispatch(const PipelineData& pipeline_data, const Bindings& bindings,
+                                     const void* push, uint32_t push_size, const Dispatch& dispatch,
+                                     const CacheKey* key) {
+    VkCommandBuffer cmd = ctx().command_buffer;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, dispatch.pipeline);
+    if (pipeline_data.address_abi) {
+        // Descriptor-free: the storage bindings travel as addresses, in binding order.
+        VkDescriptorBufferInfo ranges[3];
+        uint32_t n = 0;
+        for (uint32_t binding : {0u, 1u, 3u})
+            if (bindings.mask & (1u << binding)) ranges[n++] = bindings.buffers[binding];
+        if (!push_addresses(pipeline_data, push, push_size, ranges, n)) {
+            if (dispatch.sample) tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+            return;
+        }
+    } else {
+        if (!bind_descriptors(pipeline_data, bindings, key)) {  // recording is dropped
+            if (dispatch.sample) tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+            return;
+        }
+        vkCmdPushConstants(cmd, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                           0, push_size, push);
+    }
+    record_grid(dispatch);
+}
 
-    // Submit command buffer
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
+void KernelLauncher::record_grid(const Dispatch& dispatch) {
+    const uint32_t timing = dispatch.sample ? begin_timing(dispatch) : kNoTiming;
+    vkCmdDispatch(ctx().command_buffer, dispatch.groups_x, dispatch.groups_y, 1);
+    if (timing != kNoTiming) end_timing(timing);
+}
 
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "Failed to submit command buffer" << std::endl;
+bool KernelLauncher::push_addresses(const PipelineData& pipeline_data, const void* push, uint32_t push_size,
+                                    const VkDescriptorBufferInfo* ranges, uint32_t count) {
+    ThreadContext& c = ctx();
+    UnifiedArena* arena = get_global_arena();
+    const char* failure = nullptr;
+    const uint32_t extra = push_size > kPushHeaderSize ? push_size - kPushHeaderSize : 0;  // inline captures
+    const uint32_t total = kPushHeaderSize + count * static_cast<uint32_t>(sizeof(VkDeviceAddress)) + extra;
+    if (count > pipeline_data.address_args) failure = "more arrays than the push block has addresses for";
+    else if (total > pipeline_data.push_size) failure = "the addresses and inline captures overflow the push block";
+    else if (!arena || arena->device_address() == 0) failure = "the arena has no device address";
+    for (uint32_t i = 0; i < count && !failure; ++i)
+        if (ranges[i].buffer != arena->buffer()) failure = "an array is not arena-resident";
+    if (failure) {
+        std::cerr << "[addressed] " << pipeline_data.name << ": " << failure << std::endl;
+        if (c.capture) abort_capture(failure);
+        else c.frames[c.frame_index].record_failed = true;  // submit_commands drops the recording
         return false;
     }
+    // Arrays passed by address carry no access qualifier: all count as written.
+    if (HazardTracker* hazards = recording_hazards())
+        track_hazards(*hazards, c.command_buffer, ranges, count, (1u << count) - 1);
 
-    fence_signaled_ = false;
+    // The launch's own push block, then one address per array, then its inline captures.
+    unsigned char block[kMaxPushSize] = {};
+    std::memcpy(block, push, std::min(push_size, kPushHeaderSize));
+    for (uint32_t i = 0; i < count; ++i) {
+        const VkDeviceAddress address = arena->device_address() + ranges[i].offset;
+        std::memcpy(block + kPushHeaderSize + i * sizeof(VkDeviceAddress), &address, sizeof(address));
+    }
+    if (extra) std::memcpy(block + total - extra, static_cast<const unsigned char*>(push) + kPushHeaderSize, extra);
+    vkCmdPushConstants(c.command_buffer, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, total, block);
     return true;
 }
 
-bool KernelLauncher::dispatch_reduce_level(PipelineData& pipeline_data,
-                                           VkBuffer src_buf, VkDeviceSize src_off, VkDeviceSize src_range,
-                                           VkBuffer dst_buf, VkDeviceSize dst_off, VkDeviceSize dst_range,
-                                           uint32_t count, uint32_t groups) {
-    // Allocate a fresh descriptor set for this level (src/dst differ each level).
-    VkDescriptorSetAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    alloc_info.descriptorPool = descriptor_pool_;
-    alloc_info.descriptorSetCount = 1;
-    alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-    VkDescriptorSet descriptor_set;
-    if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-        std::cerr << "[reduce] Failed to allocate descriptor set" << std::endl;
-        return false;
+size_t KernelLauncher::record_chunked(const PipelineData& pipeline_data, const Bindings& bindings,
+                                      const ChunkStrides& strides, size_t count, const CacheKey* key,
+                                      const void* inline_captures, size_t inline_size) {
+    VkDeviceSize elem_size = 0;
+    for (VkDeviceSize stride : strides.per_element) elem_size = std::max(elem_size, stride);
+    const size_t limit = dispatch_limit(pipeline_data, static_cast<size_t>(elem_size));
+
+    // The header, then the inline captures (whole words: push sizes are multiples of 4).
+    unsigned char push[kMaxPushSize] = {};
+    const uint32_t push_size = kPushHeaderSize + static_cast<uint32_t>((inline_size + 3) & ~size_t{3});
+    if (inline_size) std::memcpy(push + kPushHeaderSize, inline_captures, inline_size);
+    if (count <= limit) {
+        const PushBlock header = make_push_block(count);
+        std::memcpy(push, &header, sizeof(header));
+        const Dispatch dispatch = plan_dispatch(pipeline_data, count);
+        record_dispatch(pipeline_data, bindings, push, push_size, dispatch, key);
+        return dispatch.groups;
+    }
+
+    // Every chunk runs at one workgroup size (a reduction's partials of consecutive
+    // chunks must line up), so chunks are never tuning samples. They write disjoint
+    // ranges: no barrier between them.
+    const Dispatch plan = plan_dispatch(pipeline_data, limit, nullptr, false);
+    size_t groups = 0;
+    for (size_t base = 0; base < count; base += limit) {
+        const size_t n = std::min(limit, count - base);
+        Dispatch dispatch = plan;
+        dispatch.groups = static_cast<uint32_t>((n + plan.size - 1) / plan.size);
+        shape_grid(dispatch);
+        Bindings chunk = bindings;
+        for (uint32_t b = 0; b < 4; ++b) {
+            if (strides.per_element[b] == 0 && strides.per_group[b] == 0) continue;
+            chunk.buffers[b].offset += strides.per_element[b] * base + strides.per_group[b] * groups;
+            chunk.buffers[b].range = strides.per_element[b] * n + strides.per_group[b] * dispatch.groups;
+        }
+        const PushBlock header = make_push_block(n, base);
+        std::memcpy(push, &header, sizeof(header));
+        record_dispatch(pipeline_data, chunk, push, push_size, dispatch);
+        groups += dispatch.groups;
     }
+    return groups;
+}
 
-    VkDescriptorBufferInfo infos[2]{};
-    infos[0].buffer = src_buf; infos[0].offset = src_off; infos[0].range = src_range;
-    infos[1].buffer = dst_buf; infos[1].offset = dst_off; infos[1].range = dst_range;
-
-    // Binding 2 (captures uniform) is unused by the reduce kernel but present in
-    // the shared descriptor layout; bind a small dummy so the set is complete.
-    VkBuffer dummy_buf = VK_NULL_HANDLE;
-    VkDeviceMemory dummy_mem = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{};
-    ubi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    ubi.size = 64;
-    ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &dummy_buf);
-    VkMemoryRequirements mr;
-    vkGetBufferMemoryRequirements(backend_->device(), dummy_buf, &mr);
-    VkMemoryAllocateInfo mai{};
-    mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(
-        mr.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &dummy_mem);
-    vkBindBufferMemory(backend_->device(), dummy_buf, dummy_mem, 0);
-    VkDescriptorBufferInfo dummy_info{dummy_buf, 0, VK_WHOLE_SIZE};
-    transient_buffers_.emplace_back(dummy_buf, dummy_mem);
-
-    VkWriteDescriptorSet writes[3]{};
-    for (int i = 0; i < 2; ++i) {
-        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[i].dstSet = descriptor_set;
-        writes[i].dstBinding = i;
-        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writes[i].descriptorCount = 1;
-        writes[i].pBufferInfo = &infos[i];
-    }
-    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[2].dstSet = descriptor_set;
-    writes[2].dstBinding = 2;
-    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[2].descriptorCount = 1;
-    writes[2].pBufferInfo = &dummy_info;
-    vkUpdateDescriptorSets(backend_->device(), 3, writes, 0, nullptr);
+uint64_t KernelLauncher::max_groups(const PipelineData& pipeline_data) const {
+    const VkPhysicalDeviceLimits& limits = backend_->limits();
+    return static_cast<uint64_t>(limits.maxComputeWorkGroupCount[0]) *
+           (pipeline_data.grid_2d ? limits.maxComputeWorkGroupCount[1] : 1);
+}
 
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
+size_t KernelLauncher::dispatch_limit(const PipelineData& pipeline_data, size_t elem_size) const {
+    // The smallest size the kernel may be planned at covers the fewest elements.
+    const uint64_t size = pipeline_data.variants.empty() ? pipeline_data.workgroup_size
+                                                         : pipeline_data.variants.front().size;
+    uint64_t limit = std::min<uint64_t>(max_groups(pipeline_data) * size, 1ull << 31);
+    if (elem_size > 0) limit = std::min<uint64_t>(limit, backend_->limits().maxStorageBufferRange / elem_size);
+    // Chunk boundaries then fall on whole workgroups and on a storage-offset alignment
+    // for any element size.
+    constexpr uint64_t kChunkAlign = 1ull << 18;
+    if (limit >= kChunkAlign) limit &= ~(kChunkAlign - 1);
+    return static_cast<size_t>(limit);
+}
 
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
-    PushBlock push = make_push_block(count);
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT,
-                       0, sizeof(push), &push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "[reduce] Failed to submit command buffer" << std::endl;
-        return false;
+bool KernelLauncher::check_inline_captures(const char* tag, const PipelineData& pipeline_data,
+                                           size_t capture_size) const {
+    if (capture_size <= pipeline_data.inline_captures) return true;
+    std::cerr << tag << " " << capture_size << " bytes of captures exceed the " << pipeline_data.inline_captures
+              << " bytes " << pipeline_data.name << " reads inline on this device" << std::endl;
+    return false;
+}
+
+bool KernelLauncher::check_dispatch_limit(const char* tag, const PipelineData& pipeline_data,
+                                          size_t count, size_t elem_size) const {
+    const size_t limit = dispatch_limit(pipeline_data, elem_size);
+    if (count <= limit) return true;
+    std::cerr << tag << " " << count << " elements exceed the " << limit
+              << " one dispatch of " << pipeline_data.name << " covers on this device" << std::endl;
+    return false;
+}
+
+void KernelLauncher::shape_grid(Dispatch& dispatch) const {
+    // Workgroups past maxComputeWorkGroupCount[0] continue in y; only kernels that
+    // linearize their workgroup id are planned that large (dispatch_limit).
+    const uint32_t max_x = backend_->limits().maxComputeWorkGroupCount[0];
+    dispatch.groups_x = std::min(dispatch.groups, max_x);
+    dispatch.groups_y = dispatch.groups_x ? (dispatch.groups + dispatch.groups_x - 1) / dispatch.groups_x : 1;
+}
+
+KernelLauncher::Dispatch KernelLauncher::plan_dispatch(const PipelineData& pipeline_data, size_t count,
+                                                       const PipelineData* partner, bool timed) {
+    Dispatch dispatch;
+    dispatch.pipeline = pipeline_data.pipeline;
+    dispatch.size = pipeline_data.workgroup_size;
+    dispatch.kernel = pipeline_data.spirv_hash;
+    if (partner) dispatch.kernel = (dispatch.kernel * 0x100000001b3ull) ^ partner->spirv_hash;
+    dispatch.bucket = WorkgroupTuner::bucket_of(count);
+    if (tuner_ && !pipeline_data.variants.empty()) {
+        // Sizes this kernel (and its partner) offer whose group count stays within the
+        // device limit for `count`.
+        auto offers = [](const PipelineData& pd, uint32_t size) {
+            return pd.workgroup_size == size || pd.pipeline_for(size) != pd.pipeline;
+        };
+        const uint64_t limit = partner ? std::min(max_groups(pipeline_data), max_groups(*partner))
+                                       : max_groups(pipeline_data);
+        std::vector<uint32_t> sizes;
+        for (const PipelineData::Variant& variant : pipeline_data.variants) {
+            if ((count + variant.size - 1) / variant.size > limit) continue;
+            if (partner && !offers(*partner, variant.size)) continue;
+            sizes.push_back(variant.size);
+        }
+        if (!sizes.empty()) {
+            const bool own = std::find(sizes.begin(), sizes.end(), pipeline_data.workgroup_size) != sizes.end();
+            bool sample = false;
+            // A captured launch replays as recorded: it takes the winner, never a sample.
+            dispatch.size = tuner_->choose(dispatch.kernel, dispatch.bucket, sizes,
+                                           own ? pipeline_data.workgroup_size : sizes.back(),
+                                           timed && !capturing() ? &sample : nullptr);
+            dispatch.sample = sample;
+            dispatch.pipeline = pipeline_data.pipeline_for(dispatch.size);
+        }
     }
-    fence_signaled_ = false;
-    sync();  // each level depends on the previous one's output
-    return true;
+    dispatch.groups = static_cast<uint32_t>((count + dispatch.size - 1) / dispatch.size);
+    shape_grid(dispatch);
+    return dispatch;
+}
+
+uint32_t KernelLauncher::begin_timing(const Dispatch& dispatch) {
+    ThreadContext& c = ctx();
+    Frame& frame = c.frames[c.frame_index];
+    if (c.capture || c.timing_pool == VK_NULL_HANDLE || frame.timings.size() >= kFrameTimings) {
+        tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+        return kNoTiming;
+    }
+    const uint32_t query = 2 * (kFrameTimings * c.frame_index + static_cast<uint32_t>(frame.timings.size()));
+    vkCmdResetQueryPool(c.command_buffer, c.timing_pool, query, 2);
+    vkCmdWriteTimestamp(c.command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, c.timing_pool, query);
+    frame.timings.push_back({dispatch.kernel, dispatch.bucket, dispatch.size, query});
+    return query;
+}
+
+void KernelLauncher::end_timing(uint32_t query) {
+    ThreadContext& c = ctx();
+    vkCmdWriteTimestamp(c.command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, c.timing_pool, query + 1);
+}
+
+void KernelLauncher::collect_timings(Frame& frame, bool executed) {
+    if (frame.timings.empty()) return;
+    VkQueryPool pool = ctx().timing_pool;
+    for (const Frame::Timing& t : frame.timings) {
+        uint64_t stamps[2] = {};
+        if (executed &&
+            vkGetQueryPoolResults(backend_->device(), pool, t.query, 2, sizeof(stamps), stamps,
+                                  sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+            const uint64_t ticks = (stamps[1] - stamps[0]) & timestamp_mask_;
+            tuner_->record(t.kernel, t.bucket, t.size, static_cast<uint64_t>(ticks * timestamp_period_));
+        } else {
+            tuner_->cancel(t.kernel, t.bucket, t.size);
+        }
+    }
+    frame.timings.clear();
 }
 
-bool KernelLauncher::launch_reduce(const std::string& kernel_name, void* data, size_t count,
+const void* KernelLauncher::record_result_readback(VkBuffer src, VkDeviceSize src_off, VkDeviceSize size) {
+    ThreadContext& c = ctx();
+    Frame& frame = c.frames[c.frame_index];
+    VkBuffer slot = frame.result_buffer;
+    void* slot_mapped = frame.result_mapped;
+    if (Graph* graph = c.capture) {
+        // Frame slots are reused; a graph's result lands in a slot of its own.
+        VkDeviceMemory mem = VK_NULL_HANDLE;
+        if (!create_host_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, slot, mem, &slot_mapped))
+            return nullptr;
+        graph->buffers.emplace_back(slot, mem);
+    } else if (!slot_mapped || size > kResultSlotSize || frame.result_used) {
+        return nullptr;  // (one result per recording: deferred launches share a frame)
+    } else {
+        frame.result_used = true;
+    }
+    if (HazardTracker* hazards = recording_hazards()) {
+        const VkDescriptorBufferInfo source{src, src_off, size};
+        track_hazards(*hazards, c.command_buffer, &source, 1, 0);
+    }
+    // compute writes -> transfer read, copy, then transfer write -> host read so the
+    // bytes are visible through the mapping once the fence signals.
+    VkMemoryBarrier to_xfer{};
+    to_xfer.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    to_xfer.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    to_xfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(c.command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 1, &to_xfer, 0, nullptr, 0, nullptr);
+    VkBufferCopy region{src_off, 0, size};
+    vkCmdCopyBuffer(c.command_buffer, src, slot, 1, &region);
+    VkMemoryBarrier to_host{};
+    to_host.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    to_host.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_host.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(c.command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                         0, 1, &to_host, 0, nullptr, 0, nullptr);
+    return slot_mapped;
+}
+
+bool KernelLauncher::launch_reduce(const PipelineHandle& kernel, void* data, size_t count,
                                    size_t elem_size, void* out_result) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) {
-        std::cerr << "Kernel not found: " << kernel_name << std::endl;
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto it = kernel.get();
+    if (!it) {
+        std::cerr << "Kernel not loaded" << std::endl;
         return false;
     }
-    auto& pipeline_data = it->second;
+    auto& pipeline_data = *it;
 
-    if (count == 0) { std::memset(out_result, 0, elem_size); return true; }
-    if (count == 1) { std::memcpy(out_result, data, elem_size); return true; }
+    if (count <= 1) {
+        // Nothing to dispatch. Still an epilogue, so the value is taken after earlier
+        // in-flight work (and on every replay of a graph).
+        when_complete([data, count, elem_size, out_result] {
+            if (count == 0) std::memset(out_result, 0, elem_size);
+            else std::memcpy(out_result, data, elem_size);
+        });
+        return true;
+    }
 
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) {
@@ -925,78 +2042,121 @@ bool KernelLauncher::launch_reduce(const std::string& kernel_name, void* data, s
     }
 
     // Two ping-pong scratch buffers in the arena, each large enough for one
-    // level's partials (first level is the largest).
-    size_t first_groups = (count + 255) / 256;
+    // level's partials (first level is the largest). Each level's workgroup size is
+    // planned separately, so size them for the smallest the kernel can run with.
+    const size_t min_size = pipeline_data.variants.empty() ? pipeline_data.workgroup_size
+                                                           : pipeline_data.variants.front().size;
+    size_t first_groups = (count + min_size - 1) / min_size;
+    size_t second_groups = (first_groups + min_size - 1) / min_size + 1;
     void* scratch[2];
     scratch[0] = arena->allocate(first_groups * elem_size, 256);
-    scratch[1] = arena->allocate(((first_groups + 255) / 256 + 1) * elem_size, 256);
+    scratch[1] = arena->allocate(second_groups * elem_size, 256);
     if (!scratch[0] || !scratch[1]) {
         std::cerr << "[reduce] arena scratch allocation failed" << std::endl;
+        if (scratch[0]) arena->deallocate(scratch[0]);
+        if (scratch[1]) arena->deallocate(scratch[1]);
         return false;
     }
 
-    void*  src = data;
-    size_t n = count;
-    int    toggle = 0;
-    while (n > 1) {
-        uint32_t groups = static_cast<uint32_t>((n + 255) / 256);
-        void* dst = scratch[toggle];
-
-        // Resolve src binding (arena zero-copy, else register external buffer).
-        VkBuffer src_buf; VkDeviceSize src_off; VkDeviceSize src_range = n * elem_size;
-        if (arena->contains(src)) {
-            src_buf = arena->buffer();
-            src_off = arena->offset_of(src);
-        } else {
-            VkBuffer reg = memory_manager_->get_buffer(src);
-            if (reg == VK_NULL_HANDLE) {
-                memory_manager_->register_external_buffer(src, n * elem_size);
-                reg = memory_manager_->get_buffer(src);
-            }
-            if (reg == VK_NULL_HANDLE) { std::cerr << "[reduce] bad src buffer" << std::endl; return false; }
-            memory_manager_->sync_before_kernel(src);
-            src_buf = reg; src_off = 0; src_range = VK_WHOLE_SIZE;
+    // Resolve the level-0 source (arena zero-copy, else register external buffer).
+    VkDescriptorBufferInfo src_info{VK_NULL_HANDLE, 0, static_cast<VkDeviceSize>(count) * elem_size};
+    if (arena->contains(data)) {
+        src_info.buffer = arena->buffer();
+        src_info.offset = arena->offset_of(data);
+    } else {
+        VkBuffer reg = memory_manager_->get_buffer(data);
+        if (reg == VK_NULL_HANDLE) {
+            memory_manager_->register_external_buffer(data, count * elem_size);
+            reg = memory_manager_->get_buffer(data);
         }
-
-        // dst is always arena scratch -> zero-copy bind at its offset.
-        VkBuffer dst_buf = arena->buffer();
-        VkDeviceSize dst_off = arena->offset_of(dst);
-        VkDeviceSize dst_range = static_cast<VkDeviceSize>(groups) * elem_size;
-
-        if (!dispatch_reduce_level(pipeline_data, src_buf, src_off, src_range,
-                                   dst_buf, dst_off, dst_range,
-                                   static_cast<uint32_t>(n), groups)) {
+        if (reg == VK_NULL_HANDLE) {
+            std::cerr << "[reduce] bad src buffer" << std::endl;
+            arena->deallocate(scratch[0]);
+            arena->deallocate(scratch[1]);
             return false;
         }
+        memory_manager_->sync_before_kernel(data);
+        src_info = {reg, 0, VK_WHOLE_SIZE};
+    }
+
+    // The scratch buffers are always arena-resident -> zero-copy bind at their offsets.
+    // Every level after the first reads one scratch and writes the other, so three
+    // bindings cover the whole chain: data->s0, s0->s1, s1->s0. The kernel reads only
+    // `count` elements (push constant), so binding the full scratch range is safe.
+    VkDescriptorBufferInfo s_info[2] = {
+        {arena->buffer(), arena->offset_of(scratch[0]), static_cast<VkDeviceSize>(first_groups) * elem_size},
+        {arena->buffer(), arena->offset_of(scratch[1]), static_cast<VkDeviceSize>(second_groups) * elem_size},
+    };
+    VkDescriptorBufferInfo dummy_info = zero_uniform();
+    Bindings chain[3] = {
+        {src_info, s_info[0], dummy_info},
+        {s_info[0], s_info[1], dummy_info},
+        {s_info[1], s_info[0], dummy_info},
+    };
+    for (Bindings& level : chain) level.reads = 1u << 0;  // each level only reads its source
+
+    begin_commands();
 
-        src = dst;
-        n = groups;
-        toggle ^= 1;
+    // Record every level (data -> partials -> ... -> one element) with a compute barrier
+    // between levels: each level reads the partials the previous one wrote. A level
+    // larger than one dispatch runs in chunks, each writing its partials right after
+    // the previous chunk's.
+    ChunkStrides strides;
+    strides.per_element[0] = elem_size;
+    strides.per_group[1] = elem_size;
+    size_t n = count;
+    int level = 0;
+    while (n > 1) {
+        if (level > 0) record_compute_barrier(ctx().command_buffer);
+        const Bindings& bindings = level == 0 ? chain[0] : chain[(level & 1) ? 1 : 2];
+        n = record_chunked(pipeline_data, bindings, strides, n);
+        ++level;
+    }
+    // The last level wrote scratch[(level - 1) & 1], which now holds the single reduced
+    // element; copy just those bytes to the host readback slot (no arena migration).
+    void* result = scratch[(level - 1) & 1];
+    const void* readback = record_result_readback(arena->buffer(), arena->offset_of(result), elem_size);
+    if (!submit_commands("[reduce]")) {  // single wait for the whole chain
+        arena->deallocate(scratch[0]);
+        arena->deallocate(scratch[1]);
+        return false;
     }
 
-    // src now holds the single reduced element in arena memory. On a discrete GPU the
-    // result is in the device buffer, so migrate it to the host mapping before reading
-    // (no-op on UMA; the RAII scope also invalidates at exit for the caller's data).
-    if (arena) arena->invalidate_from_device();
-    std::memcpy(out_result, src, elem_size);
-    arena->deallocate(scratch[0]);
-    arena->deallocate(scratch[1]);
+    // Epilogue once the chain has completed (right away unless async).
+    when_complete([arena, readback, result, out_result, elem_size] {
+        if (readback) {
+            std::memcpy(out_result, readback, elem_size);
+        } else {
+            // No readback slot: migrate the device result to the host mapping (no-op on UMA).
+            arena->invalidate_from_device();
+            std::memcpy(out_result, result, elem_size);
+        }
+    });
+    void* s0 = scratch[0];
+    void* s1 = scratch[1];
+    when_retired([arena, s0, s1] {
+        arena->deallocate(s0);
+        arena->deallocate(s1);
+    });
     return true;
 }
 
-size_t KernelLauncher::launch_argminmax(const std::string& kernel_name, void* data, size_t count,
+size_t KernelLauncher::launch_argminmax(const PipelineHandle& kernel, void* data, size_t count,
                                         size_t elem_size, bool is_float, bool want_max, bool want_last) {
-    ArenaSyncScope __arena_sync;
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) { std::cerr << "Kernel not found: " << kernel_name << std::endl; return count; }
-    auto& pd = it->second;
+    ArenaSyncScope __arena_sync(this);
+    auto it = kernel.get();
+    if (!it) { std::cerr << "Kernel not loaded" << std::endl; return count; }
+    auto& pd = *it;
+    if (capturing()) { abort_capture("[argmm] combines per-block winners on the host"); return count; }
     if (count == 0) return 0;
     if (count == 1) return 0;
 
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) { std::cerr << "[argmm] requires arena" << std::endl; return count; }
+    if (!check_dispatch_limit("[argmm]", pd, count, elem_size)) return count;  // per-block winners are not chunked
 
-    const uint32_t groups = static_cast<uint32_t>((count + 255) / 256);
+    const Dispatch dispatch = plan_dispatch(pd, count);
+    const uint32_t groups = dispatch.groups;
 
     // Resolve data@0 (arena zero-copy, else register + upload).
     VkBuffer data_buf; VkDeviceSize data_off; VkDeviceSize data_range = count * elem_size;
@@ -1015,59 +2175,18 @@ size_t KernelLauncher::launch_argminmax(const std::string& kernel_name, void* da
     if (!vals || !idxs) { std::cerr << "[argmm] scratch alloc failed" << std::endl; return count; }
     VkDeviceSize vals_off = arena->offset_of(vals), idxs_off = arena->offset_of(idxs);
 
-    VkDescriptorSetAllocateInfo ai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    ai.descriptorPool = descriptor_pool_; ai.descriptorSetCount = 1; ai.pSetLayouts = &pd.descriptor_set_layout;
-    VkDescriptorSet dset;
-    if (vkAllocateDescriptorSets(backend_->device(), &ai, &dset) != VK_SUCCESS) {
-        std::cerr << "[argmm] descriptor alloc failed" << std::endl; return count;
-    }
     // A dummy uniform for the shared layout's binding 2 (unused by this kernel).
-    VkBuffer ub = VK_NULL_HANDLE; VkDeviceMemory um = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-    ubi.size = 64; ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT; ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &ub);
-    VkMemoryRequirements mr; vkGetBufferMemoryRequirements(backend_->device(), ub, &mr);
-    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(mr.memoryTypeBits,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &um);
-    vkBindBufferMemory(backend_->device(), ub, um, 0);
-    transient_buffers_.emplace_back(ub, um);
-
-    VkDescriptorBufferInfo bi[4];
-    bi[0] = {data_buf, data_off, data_range};
-    bi[1] = {arena->buffer(), vals_off, static_cast<VkDeviceSize>(groups) * elem_size};
-    bi[2] = {ub, 0, VK_WHOLE_SIZE};
-    bi[3] = {arena->buffer(), idxs_off, static_cast<VkDeviceSize>(groups) * sizeof(uint32_t)};
-    VkWriteDescriptorSet w[4]{};
-    const VkDescriptorType types[4] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
-    for (int i = 0; i < 4; ++i) {
-        w[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet = dset; w[i].dstBinding = i;
-        w[i].descriptorType = types[i]; w[i].descriptorCount = 1; w[i].pBufferInfo = &bi[i];
-    }
-    vkUpdateDescriptorSets(backend_->device(), 4, w, 0, nullptr);
+    const VkDescriptorBufferInfo idxs_info{arena->buffer(), idxs_off, static_cast<VkDeviceSize>(groups) * sizeof(uint32_t)};
+    const Bindings bindings({data_buf, data_off, data_range},
+                            {arena->buffer(), vals_off, static_cast<VkDeviceSize>(groups) * elem_size},
+                            zero_uniform(), &idxs_info);
 
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
-    VkCommandBufferBeginInfo begin{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pd.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pd.layout, 0, 1, &dset, 0, nullptr);
+    begin_commands();
     struct { uint32_t count; uint32_t want_max; uint32_t want_last; }
         push{static_cast<uint32_t>(count), want_max ? 1u : 0u, want_last ? 1u : 0u};
-    vkCmdPushConstants(command_buffer_, pd.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    si.commandBufferCount = 1; si.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &si, fence_) != VK_SUCCESS) {
-        std::cerr << "[argmm] submit failed" << std::endl; return count;
-    }
-    fence_signaled_ = false; sync();
+    record_dispatch(pd, bindings, &push, sizeof(push), dispatch);
+    if (!submit_commands("[argmm]")) return count;
+    sync();  // the host combine below needs the winners now, even in async mode
     arena->invalidate_from_device();  // make vals/idxs host-visible (no-op on UMA)
 
     // Host combine over the `groups` per-block winners. Compare values by type; ties ->
@@ -1098,17 +2217,20 @@ size_t KernelLauncher::launch_argminmax(const std::string& kernel_name, void* da
     return best_idx == count ? 0 : best_idx;
 }
 
-size_t KernelLauncher::launch_find(const std::string& kernel_name, void* data, size_t count,
+size_t KernelLauncher::launch_find(const PipelineHandle& kernel, void* data, size_t count,
                                    size_t elem_size, bool negate, const void* value) {
-    ArenaSyncScope __arena_sync;
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) { std::cerr << "Kernel not found: " << kernel_name << std::endl; return count; }
-    auto& pd = it->second;
+    ArenaSyncScope __arena_sync(this);
+    auto it = kernel.get();
+    if (!it) { std::cerr << "Kernel not loaded" << std::endl; return count; }
+    auto& pd = *it;
+    if (capturing()) { abort_capture("[find] combines per-block winners on the host"); return count; }
     if (count == 0) return 0;
 
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) { std::cerr << "[find] requires arena" << std::endl; return count; }
-    const uint32_t groups = static_cast<uint32_t>((count + 255) / 256);
+    if (!check_dispatch_limit("[find]", pd, count, elem_size)) return count;  // per-block winners are not chunked
+    const Dispatch dispatch = plan_dispatch(pd, count);
+    const uint32_t groups = dispatch.groups;
 
     VkBuffer data_buf; VkDeviceSize data_off; VkDeviceSize data_range = count * elem_size;
     if (arena->contains(data)) { data_buf = arena->buffer(); data_off = arena->offset_of(data); }
@@ -1124,59 +2246,18 @@ size_t KernelLauncher::launch_find(const std::string& kernel_name, void* data, s
     if (!outi) { std::cerr << "[find] scratch alloc failed" << std::endl; return count; }
     VkDeviceSize outi_off = arena->offset_of(outi);
 
-    VkDescriptorSetAllocateInfo ai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    ai.descriptorPool = descriptor_pool_; ai.descriptorSetCount = 1; ai.pSetLayouts = &pd.descriptor_set_layout;
-    VkDescriptorSet dset;
-    if (vkAllocateDescriptorSets(backend_->device(), &ai, &dset) != VK_SUCCESS) {
-        std::cerr << "[find] descriptor alloc failed" << std::endl; return count;
-    }
-    VkBuffer ub = VK_NULL_HANDLE; VkDeviceMemory um = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-    ubi.size = 64; ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT; ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &ub);
-    VkMemoryRequirements mr; vkGetBufferMemoryRequirements(backend_->device(), ub, &mr);
-    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(mr.memoryTypeBits,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &um);
-    vkBindBufferMemory(backend_->device(), ub, um, 0);
-    transient_buffers_.emplace_back(ub, um);
-
-    VkDescriptorBufferInfo bi[3];
-    bi[0] = {data_buf, data_off, data_range};
-    bi[1] = {arena->buffer(), outi_off, static_cast<VkDeviceSize>(groups) * sizeof(uint32_t)};
-    bi[2] = {ub, 0, VK_WHOLE_SIZE};
-    VkWriteDescriptorSet w[3]{};
-    const VkDescriptorType types[3] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER};
-    for (int i = 0; i < 3; ++i) {
-        w[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet = dset; w[i].dstBinding = i;
-        w[i].descriptorType = types[i]; w[i].descriptorCount = 1; w[i].pBufferInfo = &bi[i];
-    }
-    vkUpdateDescriptorSets(backend_->device(), 3, w, 0, nullptr);
+    const Bindings bindings({data_buf, data_off, data_range},
+                            {arena->buffer(), outi_off, static_cast<VkDeviceSize>(groups) * sizeof(uint32_t)},
+                            zero_uniform());
 
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
-    VkCommandBufferBeginInfo begin{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pd.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pd.layout, 0, 1, &dset, 0, nullptr);
+    begin_commands();
     // push { uint count@0, uint negate@4, elem value@8 } — value used only by find(value).
     struct { uint32_t count; uint32_t negate; uint64_t value; }
         push{static_cast<uint32_t>(count), negate ? 1u : 0u, 0};
     if (value && elem_size <= 8) std::memcpy(&push.value, value, elem_size);
-    vkCmdPushConstants(command_buffer_, pd.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    si.commandBufferCount = 1; si.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &si, fence_) != VK_SUCCESS) {
-        std::cerr << "[find] submit failed" << std::endl; return count;
-    }
-    fence_signaled_ = false; sync();
+    record_dispatch(pd, bindings, &push, sizeof(push), dispatch);
+    if (!submit_commands("[find]")) return count;
+    sync();  // the host min below needs the winners now, even in async mode
     arena->invalidate_from_device();
 
     // Overall min of the per-block winners (each is its block's first match, or count).
@@ -1189,17 +2270,20 @@ size_t KernelLauncher::launch_find(const std::string& kernel_name, void* data, s
     return best;  // count == not found
 }
 
-size_t KernelLauncher::launch_mismatch(const std::string& kernel_name, void* a, void* b,
+size_t KernelLauncher::launch_mismatch(const PipelineHandle& kernel, void* a, void* b,
                                        size_t count, size_t elem_size) {
-    ArenaSyncScope __arena_sync;
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) { std::cerr << "Kernel not found: " << kernel_name << std::endl; return count; }
-    auto& pd = it->second;
+    ArenaSyncScope __arena_sync(this);
+    auto it = kernel.get();
+    if (!it) { std::cerr << "Kernel not loaded" << std::endl; return count; }
+    auto& pd = *it;
+    if (capturing()) { abort_capture("[mismatch] combines per-block winners on the host"); return count; }
     if (count == 0) return 0;
 
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) { std::cerr << "[mismatch] requires arena" << std::endl; return count; }
-    const uint32_t groups = static_cast<uint32_t>((count + 255) / 256);
+    if (!check_dispatch_limit("[mismatch]", pd, count, elem_size)) return count;  // per-block winners are not chunked
+    const Dispatch dispatch = plan_dispatch(pd, count);
+    const uint32_t groups = dispatch.groups;
 
     auto resolve = [&](void* p, const char* tag, VkBuffer& buf, VkDeviceSize& off, VkDeviceSize& range) -> bool {
         range = count * elem_size;
@@ -1217,57 +2301,16 @@ size_t KernelLauncher::launch_mismatch(const std::string& kernel_name, void* a,
     if (!outi) { std::cerr << "[mismatch] scratch alloc failed" << std::endl; return count; }
     VkDeviceSize outi_off = arena->offset_of(outi);
 
-    VkDescriptorSetAllocateInfo ai{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
-    ai.descriptorPool = descriptor_pool_; ai.descriptorSetCount = 1; ai.pSetLayouts = &pd.descriptor_set_layout;
-    VkDescriptorSet dset;
-    if (vkAllocateDescriptorSets(backend_->device(), &ai, &dset) != VK_SUCCESS) {
-        std::cerr << "[mismatch] descriptor alloc failed" << std::endl; return count;
-    }
-    VkBuffer ub = VK_NULL_HANDLE; VkDeviceMemory um = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
-    ubi.size = 64; ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT; ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &ub);
-    VkMemoryRequirements mr; vkGetBufferMemoryRequirements(backend_->device(), ub, &mr);
-    VkMemoryAllocateInfo mai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(mr.memoryTypeBits,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &um);
-    vkBindBufferMemory(backend_->device(), ub, um, 0);
-    transient_buffers_.emplace_back(ub, um);
-
-    VkDescriptorBufferInfo bi[4];
-    bi[0] = {a_buf, a_off, a_range};
-    bi[1] = {arena->buffer(), outi_off, static_cast<VkDeviceSize>(groups) * sizeof(uint32_t)};
-    bi[2] = {ub, 0, VK_WHOLE_SIZE};
-    bi[3] = {b_buf, b_off, b_range};
-    VkWriteDescriptorSet w[4]{};
-    const VkDescriptorType types[4] = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
-    for (int i = 0; i < 4; ++i) {
-        w[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet = dset; w[i].dstBinding = i;
-        w[i].descriptorType = types[i]; w[i].descriptorCount = 1; w[i].pBufferInfo = &bi[i];
-    }
-    vkUpdateDescriptorSets(backend_->device(), 4, w, 0, nullptr);
+    const VkDescriptorBufferInfo b_info{b_buf, b_off, b_range};
+    const Bindings bindings({a_buf, a_off, a_range},
+                            {arena->buffer(), outi_off, static_cast<VkDeviceSize>(groups) * sizeof(uint32_t)},
+                            zero_uniform(), &b_info);
 
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
-    VkCommandBufferBeginInfo begin{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
-    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pd.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pd.layout, 0, 1, &dset, 0, nullptr);
+    begin_commands();
     uint32_t push = static_cast<uint32_t>(count);
-    vkCmdPushConstants(command_buffer_, pd.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
-    si.commandBufferCount = 1; si.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &si, fence_) != VK_SUCCESS) {
-        std::cerr << "[mismatch] submit failed" << std::endl; return count;
-    }
-    fence_signaled_ = false; sync();
+    record_dispatch(pd, bindings, &push, sizeof(push), dispatch);
+    if (!submit_commands("[mismatch]")) return count;
+    sync();  // the host min below needs the winners now, even in async mode
     arena->invalidate_from_device();
 
     const uint32_t* w_arr = static_cast<const uint32_t*>(outi);
@@ -1277,12 +2320,87 @@ size_t KernelLauncher::launch_mismatch(const std::string& kernel_name, void* a,
     return best;  // count == ranges equal
 }
 
-bool KernelLauncher::launch_scan(const std::string& scan_kernel, const std::string& add_kernel,
+bool KernelLauncher::plan_scan(const PipelineData& scan_pd, const PipelineData& add_pd,
+                               const VkDescriptorBufferInfo& data, size_t count, size_t elem_size,
+                               ScanPlan& plan) {
+    plan.levels.clear();
+    plan.scratch = nullptr;
+    if (count <= 1) return true;  // inclusive scan of <=1 element is the identity
+
+    UnifiedArena* arena = get_global_arena();
+    if (!arena || !arena->valid()) { std::cerr << "[scan] requires arena" << std::endl; return false; }
+    // Level 0 is one dispatch (the block offsets are not chunked); larger levels only shrink.
+    if (!check_dispatch_limit("[scan]", scan_pd, count, elem_size) ||
+        !check_dispatch_limit("[scan]", add_pd, count, elem_size))
+        return false;
+
+    // Level i scans count_i elements in workgroup-wide blocks and writes groups_i block
+    // totals; those totals are level i+1's data. Recursion stops at the first level that
+    // fits one workgroup. Each level's scan and add run at one workgroup size (the add
+    // reads the scan's block layout), planned per level. Lay every level's block sums out
+    // in one arena block (256-byte aligned sub-ranges, a valid storage-buffer offset
+    // alignment on every device we target).
+    std::vector<VkDeviceSize> sums_off;
+    VkDeviceSize total = 0;
+    for (size_t n = count; ; ) {
+        const Dispatch scan = plan_dispatch(scan_pd, n, &add_pd);
+        Dispatch add = scan;
+        add.pipeline = add_pd.pipeline_for(scan.size);
+        add.sample = false;
+        plan.levels.push_back({Bindings{}, static_cast<uint32_t>(n), scan, add});
+        sums_off.push_back(total);
+        total += (static_cast<VkDeviceSize>(scan.groups) * elem_size + 255) & ~VkDeviceSize(255);
+        if (scan.groups == 1) break;
+        n = scan.groups;
+    }
+
+    plan.scratch = arena->allocate(total, 256);
+    if (!plan.scratch) {
+        std::cerr << "[scan] scratch alloc failed" << std::endl;
+        for (const ScanLevel& lv : plan.levels)
+            if (lv.scan.sample) tuner_->cancel(lv.scan.kernel, lv.scan.bucket, lv.scan.size);
+        plan.levels.clear();
+        return false;
+    }
+    const VkDeviceSize base = arena->offset_of(plan.scratch);
+    VkDescriptorBufferInfo dummy_info = zero_uniform();
+
+    for (size_t i = 0; i < plan.levels.size(); ++i) {
+        ScanLevel& lv = plan.levels[i];
+        VkDescriptorBufferInfo data_info = i == 0 ? data
+            : VkDescriptorBufferInfo{arena->buffer(), base + sums_off[i - 1],
+                                     static_cast<VkDeviceSize>(lv.count) * elem_size};
+        VkDescriptorBufferInfo sums_info{arena->buffer(), base + sums_off[i],
+                                         static_cast<VkDeviceSize>(lv.scan.groups) * elem_size};
+        lv.bindings = Bindings(data_info, sums_info, dummy_info);
+    }
+    return true;
+}
+
+void KernelLauncher::record_scan(const ScanPlan& plan, const PipelineData& scan_pd, const PipelineData& add_pd) {
+    // Down-sweep: per-block inclusive scan of every level (data in place + block totals),
+    // each level reading the totals the previous one wrote.
+    for (size_t i = 0; i < plan.levels.size(); ++i) {
+        if (i > 0) record_compute_barrier(ctx().command_buffer);
+        PushBlock push = make_push_block(plan.levels[i].count);
+        record_dispatch(scan_pd, plan.levels[i].bindings, &push, sizeof(push), plan.levels[i].scan);
+    }
+    // Up-sweep: from the second-to-last level down to level 0, add each block's exclusive
+    // offset (= the fully scanned totals of the level above, at [wg-1]).
+    for (size_t i = plan.levels.size(); i-- > 0; ) {
+        if (plan.levels[i].add.groups <= 1) continue;
+        record_compute_barrier(ctx().command_buffer);
+        PushBlock push = make_push_block(plan.levels[i].count);
+        record_dispatch(add_pd, plan.levels[i].bindings, &push, sizeof(push), plan.levels[i].add);
+    }
+}
+
+bool KernelLauncher::launch_scan(const PipelineHandle& scan_kernel, const PipelineHandle& add_kernel,
                                  void* data, size_t count, size_t elem_size) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto sit = pipelines_.find(scan_kernel);
-    auto ait = pipelines_.find(add_kernel);
-    if (sit == pipelines_.end() || ait == pipelines_.end()) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto sit = scan_kernel.get();
+    auto ait = add_kernel.get();
+    if (!sit || !ait) {
         std::cerr << "[scan] kernel not found" << std::endl;
         return false;
     }
@@ -1291,8 +2409,6 @@ bool KernelLauncher::launch_scan(const std::string& scan_kernel, const std::stri
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) { std::cerr << "[scan] requires arena" << std::endl; return false; }
 
-    const uint32_t num_blocks = static_cast<uint32_t>((count + 255) / 256);
-
     // Resolve the in-place data buffer (arena zero-copy, else register + upload).
     const bool data_in_arena = arena->contains(data);
     VkBuffer data_buf; VkDeviceSize data_off; VkDeviceSize data_range = count * elem_size;
@@ -1307,149 +2423,43 @@ bool KernelLauncher::launch_scan(const std::string& scan_kernel, const std::stri
         data_buf = reg; data_off = 0; data_range = VK_WHOLE_SIZE;
     }
 
-    void* blocksums = arena->allocate(num_blocks * elem_size, 256);
-    if (!blocksums) { std::cerr << "[scan] scratch alloc failed" << std::endl; return false; }
-    VkBuffer bs_buf = arena->buffer();
-    VkDeviceSize bs_off = arena->offset_of(blocksums);
-    VkDeviceSize bs_range = static_cast<VkDeviceSize>(num_blocks) * elem_size;
-
-    // Pass 1: per-block inclusive scan of data (in place) + write block totals.
-    if (!dispatch_reduce_level(sit->second, data_buf, data_off, data_range,
-                               bs_buf, bs_off, bs_range,
-                               static_cast<uint32_t>(count), num_blocks))
-        return false;
-
-    if (num_blocks > 1) {
-        // Pass 2: inclusive-scan the block sums, then add each block's exclusive offset.
-        // The block-sums scan is itself an inclusive scan, so RECURSE (multi-level) rather
-        // than cap at one workgroup — this lifts the old 256*256 = 65536-element limit. The
-        // recursion strictly shrinks (num_blocks = ceil(count/256) < count for count >= 2)
-        // and bottoms out at a single workgroup once the sub-block count reaches 1. The
-        // nested launch_scan's ArenaSyncScope is reentrancy-guarded (no re-migrate), and
-        // blocksums is arena-resident so it resolves zero-copy.
-        if (!launch_scan(scan_kernel, add_kernel, blocksums, num_blocks, elem_size))
-            return false;
-        // Pass 3: add each block's exclusive offset (= scanned blocksums[wg-1]).
-        if (!dispatch_reduce_level(ait->second, data_buf, data_off, data_range,
-                                   bs_buf, bs_off, bs_range,
-                                   static_cast<uint32_t>(count), num_blocks))
-            return false;
-    }
-
-    if (!data_in_arena) memory_manager_->sync_after_kernel(data);  // download in-place result
-    arena->deallocate(blocksums);
-    return true;
-}
-
-// Exclusive-scan finalize dispatch: in@0 (inclusive scan) -> out@1, push { uint count@0,
-// elem init@8 }. Binds a dummy uniform@2 to complete the shared 3-binding layout.
-bool KernelLauncher::dispatch_exclusive_shift(PipelineData& pipeline_data,
-                                              VkBuffer in_buf, VkDeviceSize in_off, VkDeviceSize in_range,
-                                              VkBuffer out_buf, VkDeviceSize out_off, VkDeviceSize out_range,
-                                              uint32_t count, const void* init, size_t init_bytes,
-                                              uint32_t groups) {
-    VkDescriptorSetAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    alloc_info.descriptorPool = descriptor_pool_;
-    alloc_info.descriptorSetCount = 1;
-    alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-    VkDescriptorSet descriptor_set;
-    if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-        std::cerr << "[exscan] Failed to allocate descriptor set" << std::endl;
-        return false;
-    }
-
-    VkDescriptorBufferInfo in_info{in_buf, in_off, in_range};
-    VkDescriptorBufferInfo out_info{out_buf, out_off, out_range};
-
-    // Dummy uniform for binding 2 (unused by the shift kernel but in the layout).
-    VkBuffer dummy_buf = VK_NULL_HANDLE;
-    VkDeviceMemory dummy_mem = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{};
-    ubi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    ubi.size = 64;
-    ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &dummy_buf);
-    VkMemoryRequirements mr;
-    vkGetBufferMemoryRequirements(backend_->device(), dummy_buf, &mr);
-    VkMemoryAllocateInfo mai{};
-    mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(
-        mr.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &dummy_mem);
-    vkBindBufferMemory(backend_->device(), dummy_buf, dummy_mem, 0);
-    VkDescriptorBufferInfo dummy_info{dummy_buf, 0, VK_WHOLE_SIZE};
-    transient_buffers_.emplace_back(dummy_buf, dummy_mem);
-
-    VkWriteDescriptorSet writes[3]{};
-    VkDescriptorBufferInfo* storage[2] = {&in_info, &out_info};
-    for (int i = 0; i < 2; ++i) {
-        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[i].dstSet = descriptor_set;
-        writes[i].dstBinding = i;
-        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writes[i].descriptorCount = 1;
-        writes[i].pBufferInfo = storage[i];
-    }
-    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[2].dstSet = descriptor_set;
-    writes[2].dstBinding = 2;
-    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[2].descriptorCount = 1;
-    writes[2].pBufferInfo = &dummy_info;
-    vkUpdateDescriptorSets(backend_->device(), 3, writes, 0, nullptr);
-
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
-
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
-    // push { uint count@0, elem init@8 } packed into the fixed 24-byte range.
-    unsigned char push[24] = {0};
-    std::memcpy(push + 0, &count, sizeof(uint32_t));
-    if (init && init_bytes && init_bytes <= 8) std::memcpy(push + 8, init, init_bytes);
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT,
-                       0, sizeof(push), push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "[exscan] Failed to submit command buffer" << std::endl;
+    // Plan every level up front (one scratch allocation), then record scan -> recurse ->
+    // add for all levels into one command buffer: one submit, one wait. This lifts the
+    // old 256*256 = 65536-element limit without a blocking submit per pass.
+    ScanPlan plan;
+    if (!plan_scan(*sit, *ait, {data_buf, data_off, data_range}, count, elem_size, plan))
         return false;
-    }
-    fence_signaled_ = false;
-    sync();
+    begin_commands();
+    record_scan(plan, *sit, *ait);
+    if (!submit_commands("[scan]")) { arena->deallocate(plan.scratch); return false; }
+
+    if (!data_in_arena)
+        when_complete([this, data] { memory_manager_->sync_after_kernel(data); });  // download in-place result
+    void* scratch = plan.scratch;
+    when_retired([arena, scratch] { arena->deallocate(scratch); });
     return true;
 }
 
-bool KernelLauncher::launch_exclusive_scan(const std::string& scan_kernel, const std::string& add_kernel,
-                                           const std::string& shift_kernel, void* input, void* output,
+bool KernelLauncher::launch_exclusive_scan(const PipelineHandle& scan_kernel, const PipelineHandle& add_kernel,
+                                           const PipelineHandle& shift_kernel, void* input, void* output,
                                            size_t count, size_t elem_size, const void* init) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto hit = pipelines_.find(shift_kernel);
-    if (hit == pipelines_.end()) { std::cerr << "[exscan] shift kernel not found" << std::endl; return false; }
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto sit = scan_kernel.get();
+    auto ait = add_kernel.get();
+    auto hit = shift_kernel.get();
+    if (!hit) { std::cerr << "[exscan] shift kernel not found" << std::endl; return false; }
     if (count == 0) return true;
+    if (count > 1 && (!sit || !ait)) {
+        std::cerr << "[exscan] scan kernel not found" << std::endl;
+        return false;
+    }
 
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) { std::cerr << "[exscan] requires arena" << std::endl; return false; }
+    if (!check_dispatch_limit("[exscan]", *hit, count, elem_size)) return false;
 
-    // 1) Inclusive scan of `input` in place (input is the caller's scratch copy of src).
-    //    launch_scan is reentrancy-guarded so it won't re-migrate under this scope.
-    if (count > 1 && !launch_scan(scan_kernel, add_kernel, input, count, elem_size)) return false;
-
-    // 2) Resolve the inclusive-scan buffer (in@0) and the output buffer (out@1).
+    // Resolve the inclusive-scan buffer (in@0, scanned in place; the caller passes a
+    // scratch copy of src) and the output buffer (out@1).
     auto resolve = [&](void* p, const char* tag, VkBuffer& buf, VkDeviceSize& off, VkDeviceSize& range) -> bool {
         range = count * elem_size;
         if (arena->contains(p)) { buf = arena->buffer(); off = arena->offset_of(p); return true; }
@@ -1463,113 +2473,119 @@ bool KernelLauncher::launch_exclusive_scan(const std::string& scan_kernel, const
     if (!resolve(input, "in", in_buf, in_off, in_range)) return false;
     if (!resolve(output, "out", out_buf, out_off, out_range)) return false;
 
-    // 3) Shift: out[i] = init + (i>0 ? incl[i-1] : 0).
-    const uint32_t groups = static_cast<uint32_t>((count + 255) / 256);
-    if (!dispatch_exclusive_shift(hit->second, in_buf, in_off, in_range,
-                                  out_buf, out_off, out_range,
-                                  static_cast<uint32_t>(count), init, elem_size, groups))
+    // 1) Plan the inclusive scan of `input` (no levels when count == 1).
+    ScanPlan plan;
+    if (count > 1 &&
+        !plan_scan(*sit, *ait, {in_buf, in_off, in_range}, count, elem_size, plan))
+        return false;
+
+    const Bindings shift_bindings({in_buf, in_off, in_range}, {out_buf, out_off, out_range}, zero_uniform());
+
+    // 2) Inclusive scan, then shift: out[i] = init + (i>0 ? incl[i-1] : 0), recorded as
+    //    one submission. push { uint count@0, elem init@8 } packed into the push range.
+    begin_commands();
+    if (!plan.levels.empty()) {
+        record_scan(plan, *sit, *ait);
+        record_compute_barrier(ctx().command_buffer);
+    }
+    unsigned char push[24] = {0};
+    const uint32_t count32 = static_cast<uint32_t>(count);
+    std::memcpy(push + 0, &count32, sizeof(uint32_t));
+    if (init && elem_size <= 8) std::memcpy(push + 8, init, elem_size);
+    record_dispatch(*hit, shift_bindings, push, sizeof(push), plan_dispatch(*hit, count));
+    if (!submit_commands("[exscan]")) {
+        if (plan.scratch) arena->deallocate(plan.scratch);
         return false;
+    }
 
-    if (!arena->contains(output)) memory_manager_->sync_after_kernel(output);
+    when_complete([this, arena, input, output] {
+        if (!arena->contains(input)) memory_manager_->sync_after_kernel(input);
+        if (!arena->contains(output)) memory_manager_->sync_after_kernel(output);
+    });
+    void* scratch = plan.scratch;
+    if (scratch) when_retired([arena, scratch] { arena->deallocate(scratch); });
     return true;
 }
 
 // Push block for the bitonic stage: { uint count, uint k, uint j } (12 bytes, fits
-// the shared 24-byte push range). k/j select the compare-exchange schedule.
+// the shared push range). k/j select the compare-exchange schedule.
 namespace { struct SortPush { uint32_t count; uint32_t k; uint32_t j; }; }
 
-bool KernelLauncher::dispatch_sort_stage(PipelineData& pipeline_data,
-                                         VkBuffer data_buf, VkDeviceSize data_off, VkDeviceSize data_range,
-                                         uint32_t count, uint32_t k, uint32_t j, uint32_t groups) {
-    VkDescriptorSetAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    alloc_info.descriptorPool = descriptor_pool_;
-    alloc_info.descriptorSetCount = 1;
-    alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-    VkDescriptorSet descriptor_set;
-    if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-        std::cerr << "[sort] Failed to allocate descriptor set" << std::endl;
-        return false;
-    }
-
-    // The kernel uses only binding 0; bind the same buffer at 1 and a dummy uniform
-    // at 2 so the shared 3-binding layout is fully populated (validation-clean).
-    VkDescriptorBufferInfo infos[2]{};
-    infos[0].buffer = data_buf; infos[0].offset = data_off; infos[0].range = data_range;
-    infos[1] = infos[0];
-
-    VkBuffer dummy_buf = VK_NULL_HANDLE;
-    VkDeviceMemory dummy_mem = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{};
-    ubi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    ubi.size = 64;
-    ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &dummy_buf);
-    VkMemoryRequirements mr;
-    vkGetBufferMemoryRequirements(backend_->device(), dummy_buf, &mr);
-    VkMemoryAllocateInfo mai{};
-    mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(
-        mr.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &dummy_mem);
-    vkBindBufferMemory(backend_->device(), dummy_buf, dummy_mem, 0);
-    VkDescriptorBufferInfo dummy_info{dummy_buf, 0, VK_WHOLE_SIZE};
-    transient_buffers_.emplace_back(dummy_buf, dummy_mem);
-
-    VkWriteDescriptorSet writes[3]{};
-    for (int i = 0; i < 2; ++i) {
-        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[i].dstSet = descriptor_set;
-        writes[i].dstBinding = i;
-        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writes[i].descriptorCount = 1;
-        writes[i].pBufferInfo = &infos[i];
-    }
-    writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[2].dstSet = descriptor_set;
-    writes[2].dstBinding = 2;
-    writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[2].descriptorCount = 1;
-    writes[2].pBufferInfo = &dummy_info;
-    vkUpdateDescriptorSets(backend_->device(), 3, writes, 0, nullptr);
-
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
+bool KernelLauncher::split_long_work() {
+    const ThreadContext& c = ctx();
+    if (c.capture) return false;
+    return c.priority == LaunchPriority::Low ||
+           (c.priority == LaunchPriority::Normal && backend_->high_priority_active());
+}
 
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
-    SortPush push{count, k, j};
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT,
-                       0, sizeof(push), &push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "[sort] Failed to submit command buffer" << std::endl;
-        return false;
+bool KernelLauncher::dispatch_sort_schedule(const PipelineData& pipeline_data,
+                                            VkBuffer data_buf, VkDeviceSize data_off, VkDeviceSize data_range,
+                                            uint32_t count, const Dispatch& dispatch) {
+    // Every stage binds the same buffer, so the bindings are recorded once per
+    // submission. The kernel uses only binding 0; bind the same buffer at 1 and a dummy
+    // uniform at 2 so the shared 3-binding layout is fully populated (validation-clean).
+    const VkDescriptorBufferInfo data_info{data_buf, data_off, data_range};
+    // A timed schedule stays one submission (its timestamps bracket one recording); one
+    // that would split from the start gives up its sample instead.
+    const bool sample = dispatch.sample && !split_long_work();
+    if (dispatch.sample && !sample) tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    auto begin_submission = [&]() -> bool {
+        begin_commands();
+        cmd = ctx().command_buffer;
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, dispatch.pipeline);
+        return pipeline_data.address_abi ||
+               bind_descriptors(pipeline_data, Bindings(data_info, data_info, zero_uniform()));
+    };
+    if (!begin_submission()) {
+        if (sample) tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+        return submit_commands("[sort]");  // drops the recording and reports the failure
+    }
+    // A tuning sample times the whole schedule: the stages are what the size affects.
+    const uint32_t timing = sample ? begin_timing(dispatch) : kNoTiming;
+
+    // Record the whole O(log^2 n) (k,j) schedule. Each stage reads the previous stage's
+    // writes, so a compute->compute barrier separates consecutive dispatches; (k,j) travel
+    // as push constants, which are snapshotted per dispatch at record time. A split
+    // schedule ends a submission after kSplitWork: the next one is ordered after it. The
+    // submission goes out even under deferral, which would otherwise keep it open.
+    bool first = true;
+    uint64_t work = 0;
+    for (uint64_t k = 2; k <= count; k <<= 1) {  // 64-bit: count may be 2^31
+        for (uint32_t j = static_cast<uint32_t>(k >> 1); j > 0; j >>= 1) {
+            if (!sample && work >= kSplitWork && split_long_work()) {
+                ctx().deferred_launches = 0;
+                if (!submit_recording("[sort]")) return false;
+                if (!begin_submission()) return submit_commands("[sort]");
+                first = true;
+                work = 0;
+            }
+            if (!first) record_compute_barrier(cmd);
+            first = false;
+            SortPush push{count, static_cast<uint32_t>(k), j};
+            if (pipeline_data.address_abi) {
+                // An addressed sort kernel takes the data's address after (count, k, j).
+                if (!push_addresses(pipeline_data, &push, sizeof(push), &data_info, 1)) {
+                    if (sample) tuner_->cancel(dispatch.kernel, dispatch.bucket, dispatch.size);
+                    return submit_commands("[sort]");
+                }
+            } else {
+                vkCmdPushConstants(cmd, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                                   0, sizeof(push), &push);
+            }
+            vkCmdDispatch(cmd, dispatch.groups_x, dispatch.groups_y, 1);
+            work += count;
+        }
     }
-    fence_signaled_ = false;
-    sync();  // each stage depends on the previous stage's writes
-    return true;
+    if (timing != kNoTiming) end_timing(timing);
+    return submit_commands("[sort]");  // one submission for the (rest of the) schedule
 }
 
-bool KernelLauncher::launch_sort(const std::string& kernel_name, void* data, size_t count,
+bool KernelLauncher::launch_sort(const PipelineHandle& kernel, void* data, size_t count,
                                  size_t elem_size) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto it = pipelines_.find(kernel_name);
-    if (it == pipelines_.end()) { std::cerr << "[sort] kernel not found" << std::endl; return false; }
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto it = kernel.get();
+    if (!it) { std::cerr << "[sort] kernel not found" << std::endl; return false; }
     if (count <= 1) return true;  // already sorted
 
     // MVP: bitonic sort requires a power-of-two element count.
@@ -1577,6 +2593,7 @@ bool KernelLauncher::launch_sort(const std::string& kernel_name, void* data, siz
         std::cerr << "[sort] count " << count << " is not a power of two (MVP limit)" << std::endl;
         return false;
     }
+    if (!check_dispatch_limit("[sort]", *it, count, elem_size)) return false;
 
     UnifiedArena* arena = get_global_arena();
     const bool data_in_arena = arena && arena->valid() && arena->contains(data);
@@ -1593,127 +2610,37 @@ bool KernelLauncher::launch_sort(const std::string& kernel_name, void* data, siz
     }
 
     const uint32_t n = static_cast<uint32_t>(count);
-    const uint32_t groups = (n + 255) / 256;
-    for (uint32_t k = 2; k <= n; k <<= 1) {
-        for (uint32_t j = k >> 1; j > 0; j >>= 1) {
-            if (!dispatch_sort_stage(it->second, data_buf, data_off, data_range, n, k, j, groups))
-                return false;
-        }
-    }
-
-    if (!data_in_arena) memory_manager_->sync_after_kernel(data);
-    return true;
-}
-
-bool KernelLauncher::dispatch_scatter(PipelineData& pipeline_data,
-                                      VkBuffer in_buf, VkDeviceSize in_off, VkDeviceSize in_range,
-                                      VkBuffer out_buf, VkDeviceSize out_off, VkDeviceSize out_range,
-                                      VkBuffer pos_buf, VkDeviceSize pos_off, VkDeviceSize pos_range,
-                                      uint32_t count, uint32_t groups, uint32_t num_true) {
-    VkDescriptorSetAllocateInfo alloc_info{};
-    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    alloc_info.descriptorPool = descriptor_pool_;
-    alloc_info.descriptorSetCount = 1;
-    alloc_info.pSetLayouts = &pipeline_data.descriptor_set_layout;
-    VkDescriptorSet descriptor_set;
-    if (vkAllocateDescriptorSets(backend_->device(), &alloc_info, &descriptor_set) != VK_SUCCESS) {
-        std::cerr << "[scatter] Failed to allocate descriptor set" << std::endl;
+    if (!dispatch_sort_schedule(*it, data_buf, data_off, data_range, n, plan_dispatch(*it, n)))
         return false;
-    }
-
-    VkDescriptorBufferInfo in_info{in_buf, in_off, in_range};
-    VkDescriptorBufferInfo out_info{out_buf, out_off, out_range};
-    VkDescriptorBufferInfo pos_info{pos_buf, pos_off, pos_range};
-
-    // Dummy uniform for binding 2 (unused by the scatter kernel but in the layout).
-    VkBuffer dummy_buf = VK_NULL_HANDLE;
-    VkDeviceMemory dummy_mem = VK_NULL_HANDLE;
-    VkBufferCreateInfo ubi{};
-    ubi.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    ubi.size = 64;
-    ubi.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    ubi.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    vkCreateBuffer(backend_->device(), &ubi, nullptr, &dummy_buf);
-    VkMemoryRequirements mr;
-    vkGetBufferMemoryRequirements(backend_->device(), dummy_buf, &mr);
-    VkMemoryAllocateInfo mai{};
-    mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    mai.allocationSize = mr.size;
-    mai.memoryTypeIndex = memory_manager_->find_memory_type(
-        mr.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    vkAllocateMemory(backend_->device(), &mai, nullptr, &dummy_mem);
-    vkBindBufferMemory(backend_->device(), dummy_buf, dummy_mem, 0);
-    VkDescriptorBufferInfo dummy_info{dummy_buf, 0, VK_WHOLE_SIZE};
-    transient_buffers_.emplace_back(dummy_buf, dummy_mem);
-
-    VkWriteDescriptorSet writes[4]{};
-    auto storage_write = [&](int idx, uint32_t binding, VkDescriptorBufferInfo* bi) {
-        writes[idx].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writes[idx].dstSet = descriptor_set;
-        writes[idx].dstBinding = binding;
-        writes[idx].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writes[idx].descriptorCount = 1;
-        writes[idx].pBufferInfo = bi;
-    };
-    storage_write(0, 0, &in_info);
-    storage_write(1, 1, &out_info);
-    storage_write(2, 3, &pos_info);
-    writes[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writes[3].dstSet = descriptor_set;
-    writes[3].dstBinding = 2;
-    writes[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writes[3].descriptorCount = 1;
-    writes[3].pBufferInfo = &dummy_info;
-    vkUpdateDescriptorSets(backend_->device(), 4, writes, 0, nullptr);
-
-    sync();
-    vkResetFences(backend_->device(), 1, &fence_);
-    vkResetCommandBuffer(command_buffer_, 0);
 
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(command_buffer_, &begin_info);
-    vkCmdBindPipeline(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_data.pipeline);
-    vkCmdBindDescriptorSets(command_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipeline_data.layout, 0, 1, &descriptor_set, 0, nullptr);
-    // Push { count, num_true }: copy_if's scatter reads only count; the partition
-    // scatter also reads num_true (the size of the kept block).
-    uint32_t push[2] = {count, num_true};
-    vkCmdPushConstants(command_buffer_, pipeline_data.layout, VK_SHADER_STAGE_COMPUTE_BIT,
-                       0, sizeof(push), push);
-    vkCmdDispatch(command_buffer_, groups, 1, 1);
-    vkEndCommandBuffer(command_buffer_);
-
-    VkSubmitInfo submit_info{};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &command_buffer_;
-    if (vkQueueSubmit(backend_->compute_queue(), 1, &submit_info, fence_) != VK_SUCCESS) {
-        std::cerr << "[scatter] Failed to submit command buffer" << std::endl;
-        return false;
-    }
-    fence_signaled_ = false;
-    sync();
+    if (!data_in_arena)
+        when_complete([this, data] { memory_manager_->sync_after_kernel(data); });
     return true;
 }
 
-bool KernelLauncher::launch_compact(const std::string& flags_kernel, const std::string& scan_kernel,
-                                    const std::string& add_kernel, const std::string& scatter_kernel,
+bool KernelLauncher::launch_compact(const PipelineHandle& flags_kernel, const PipelineHandle& scan_kernel,
+                                    const PipelineHandle& add_kernel, const PipelineHandle& scatter_kernel,
                                     void* input, void* output, size_t count, size_t elem_size,
-                                    bool elem_is_float, size_t* out_kept) {
-    ArenaSyncScope __arena_sync;  // migrate host<->device around this operation (no-op on UMA)
-    auto fit = pipelines_.find(flags_kernel);
-    auto scit = pipelines_.find(scatter_kernel);
-    if (fit == pipelines_.end() || scit == pipelines_.end()) {
+                                    bool elem_is_float, size_t* out_kept, bool scatter_needs_kept) {
+    ArenaSyncScope __arena_sync(this);  // migrate host<->device around this operation (no-op on UMA)
+    auto fit = flags_kernel.get();
+    auto scit = scatter_kernel.get();
+    if (!fit || !scit) {
         std::cerr << "[compact] kernel not found" << std::endl;
         return false;
     }
+    if (scatter_needs_kept && capturing()) {
+        abort_capture("[partition] needs the kept count on the host before its scatter");
+        return false;
+    }
     if (out_kept) *out_kept = 0;
     if (count == 0) return true;
 
     UnifiedArena* arena = get_global_arena();
     if (!arena || !arena->valid()) { std::cerr << "[compact] requires arena" << std::endl; return false; }
+    if (!check_dispatch_limit("[compact]", *fit, count, elem_size) ||
+        !check_dispatch_limit("[compact]", *scit, count, elem_size))
+        return false;
 
     // Resolve input/output: arena zero-copy when possible, else register the external
     // buffer (upload the input; download the output afterwards). The arena often only
@@ -1748,45 +2675,104 @@ bool KernelLauncher::launch_compact(const std::string& flags_kernel, const std::
     VkBuffer pos_buf = arena->buffer();
     VkDeviceSize pos_off = arena->offset_of(positions);
 
-    const uint32_t groups = static_cast<uint32_t>((count + 255) / 256);
-
     // 1. flags: input -> positions (1.0 if kept, else 0.0).
-    if (!dispatch_reduce_level(fit->second, in_buf, in_off, in_range, pos_buf, pos_off, range,
-                               static_cast<uint32_t>(count), groups)) {
+    // 2. inclusive scan of the flags, in place -> positions[i] = #kept in [0..i].
+    // 3. kept count = positions[count-1]; only those elem_size bytes are copied to the
+    //    host readback slot, so the arena is never migrated mid-pipeline.
+    // 4. scatter into the output.
+    // All four are recorded into one submission. The partition scatter (which writes
+    // every element) also needs the kept count as push constant num_true, so for it
+    // the scatter is a second submission once the count is known on the host.
+    auto sit = scan_kernel.get();
+    auto ait = add_kernel.get();
+    if (count > 1 && (!sit || !ait)) {
+        std::cerr << "[compact] scan kernel not found" << std::endl;
         arena->deallocate(positions); return false;
     }
-
-    // 2. inclusive scan of the flags, in place -> positions[i] = #kept in [0..i].
-    if (!launch_scan(scan_kernel, add_kernel, positions, count, elem_size)) {
+    VkDescriptorBufferInfo dummy_info = zero_uniform();
+    VkDescriptorBufferInfo pos_info{pos_buf, pos_off, range};
+    const Bindings flags_bindings({in_buf, in_off, in_range}, pos_info, dummy_info);
+    const Bindings scatter_bindings({in_buf, in_off, in_range}, {out_buf, out_off, out_range},
+                                    dummy_info, &pos_info);
+    ScanPlan plan;
+    if (count > 1 &&
+        !plan_scan(*sit, *ait, pos_info, count, elem_size, plan)) {
         arena->deallocate(positions); return false;
     }
 
-    // 3. kept count = the last inclusive-scan value. On a discrete GPU the scan wrote
-    // the device buffer, so migrate positions back to the host mapping before reading
-    // (no-op on UMA). launch_scan's own scope did not invalidate — it was nested.
-    if (arena) arena->invalidate_from_device();
+    begin_commands();
+    PushBlock flags_push = make_push_block(count);
+    record_dispatch(*fit, flags_bindings, &flags_push, sizeof(flags_push), plan_dispatch(*fit, count));
+    if (!plan.levels.empty()) {
+        record_compute_barrier(ctx().command_buffer);
+        record_scan(plan, *sit, *ait);
+    }
+    const VkDeviceSize last_off = pos_off + static_cast<VkDeviceSize>(count - 1) * elem_size;
+    const void* readback = record_result_readback(pos_buf, last_off, elem_size);
+    // Push { count, num_true }: copy_if's scatter reads only count; the partition
+    // scatter also reads num_true (the size of the kept block).
+    uint32_t scatter_push[2] = {static_cast<uint32_t>(count), 0};
+    const bool fused = readback != nullptr && !scatter_needs_kept;
+    if (fused) {
+        record_compute_barrier(ctx().command_buffer);
+        record_dispatch(*scit, scatter_bindings, scatter_push, sizeof(scatter_push), plan_dispatch(*scit, count));
+    }
+    if (!submit_commands("[compact]")) {
+        if (plan.scratch) arena->deallocate(plan.scratch);
+        arena->deallocate(positions);
+        return false;
+    }
+
     // The positions buffer holds the element type, so read the last scan value with the
     // matching width/kind: 4/8-byte float or int (double/int64 are exact for any count).
-    void* last = static_cast<char*>(positions) + (count - 1) * elem_size;
-    size_t kept;
-    if (elem_is_float)
-        kept = (elem_size >= 8) ? static_cast<size_t>(*static_cast<double*>(last))
-                                : static_cast<size_t>(*static_cast<float*>(last));
-    else
-        kept = (elem_size >= 8) ? static_cast<size_t>(*static_cast<int64_t*>(last))
-                                : static_cast<size_t>(*static_cast<int32_t*>(last));
-    if (out_kept) *out_kept = kept;
+    // Without a readback slot, fall back to migrating the arena (no-op on UMA).
+    auto read_kept = [arena, readback, positions, count, elem_size, elem_is_float]() -> size_t {
+        const void* last = readback;
+        if (!readback) {
+            arena->invalidate_from_device();
+            last = static_cast<char*>(positions) + (count - 1) * elem_size;
+        }
+        if (elem_is_float)
+            return (elem_size >= 8) ? static_cast<size_t>(*static_cast<const double*>(last))
+                                    : static_cast<size_t>(*static_cast<const float*>(last));
+        return (elem_size >= 8) ? static_cast<size_t>(*static_cast<const int64_t*>(last))
+                                : static_cast<size_t>(*static_cast<const int32_t*>(last));
+    };
+    void* scratch = plan.scratch;
+    auto finish = [this, arena, scratch, positions, output, out_arena] {
+        if (scratch) arena->deallocate(scratch);
+        if (!out_arena) memory_manager_->sync_after_kernel(output);  // download compacted result
+        arena->deallocate(positions);
+    };
 
-    // 4. scatter into the output. num_true (= kept) is read only by the partition
-    // scatter (which writes every element); copy_if's scatter ignores it.
-    if (!dispatch_scatter(scit->second, in_buf, in_off, in_range, out_buf, out_off, out_range,
-                          pos_buf, pos_off, range, static_cast<uint32_t>(count), groups,
-                          static_cast<uint32_t>(kept))) {
-        arena->deallocate(positions); return false;
+    if (fused) {
+        when_complete([this, read_kept, out_kept, output, out_arena] {
+            const size_t kept = read_kept();
+            if (out_kept) *out_kept = kept;
+            if (!out_arena) memory_manager_->sync_after_kernel(output);  // download compacted result
+        });
+        when_retired([arena, scratch, positions] {
+            if (scratch) arena->deallocate(scratch);
+            arena->deallocate(positions);
+        });
+        return true;
+    }
+    if (capturing()) {  // no readback slot for the graph: the scatter would need a host round trip
+        abort_capture("[compact] could not create a result readback slot");
+        when_retired(finish);  // the graph's recording still references the scratch
+        return false;
     }
 
-    if (!out_arena) memory_manager_->sync_after_kernel(output);  // download compacted result
-    arena->deallocate(positions);
+    // The partition scatter needs num_true on the host before it can be recorded, so
+    // this path waits for the first submission even in async mode.
+    sync();
+    const size_t kept = read_kept();
+    if (out_kept) *out_kept = kept;
+    scatter_push[1] = static_cast<uint32_t>(kept);
+    begin_commands();
+    record_dispatch(*scit, scatter_bindings, scatter_push, sizeof(scatter_push), plan_dispatch(*scit, count));
+    if (!submit_commands("[scatter]")) { finish(); return false; }
+    when_complete(finish);
     return true;
 }
 
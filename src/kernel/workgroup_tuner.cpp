@@ -0,0 +1,205 @@
+#include "parallax/workgroup_tuner.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace parallax {
+
+namespace {
+// Directory of the tuning cache, or empty when the environment names none.
+std::string cache_dir() {
+    if (const char* dir = std::getenv("PARALLAX_CACHE_DIR")) return dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) return std::string(xdg) + "/parallax";
+    if (const char* home = std::getenv("HOME")) return std::string(home) + "/.cache/parallax";
+    return {};
+}
+}  // namespace
+
+WorkgroupTuner::WorkgroupTuner(const uint8_t (&device_uuid)[VK_UUID_SIZE]) {
+    const std::string dir = cache_dir();
+    if (!dir.empty()) {
+        char hex[2 * VK_UUID_SIZE + 1] = {};
+        for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+            std::snprintf(hex + 2 * i, 3, "%02x", device_uuid[i]);
+        path_ = dir + "/workgroups-" + hex + ".txt";
+    }
+    load();
+}
+
+uint32_t WorkgroupTuner::bucket_of(size_t count) {
+    return count <= 1 ? 0 : (static_cast<uint32_t>(std::bit_width(count - 1)) + 1) / 2;
+}
+
+uint32_t WorkgroupTuner::choose(uint64_t kernel, uint32_t bucket, const std::vector<uint32_t>& sizes,
+                                uint32_t fallback, bool* sample) {
+    if (sample) *sample = false;
+    std::map<Key, uint32_t> winners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = entries_[{kernel, bucket}];
+        if (entry.winner != 0) {
+            for (uint32_t size : sizes)
+                if (size == entry.winner) return size;
+            return fallback;  // cached for sizes this build of the kernel does not offer
+        }
+        if (!sample) return fallback;
+        if (entry.trials.empty()) {
+            for (uint32_t size : sizes) entry.trials.push_back({size});
+        }
+        // Drop the sizes not offered this time: the group-count limit can rule out a
+        // small size for the larger counts of a bucket, and a trial that cannot be
+        // sampled again would hold the winner back forever.
+        std::erase_if(entry.trials, [&](const Trial& trial) {
+            return std::find(sizes.begin(), sizes.end(), trial.size) == sizes.end();
+        });
+        Trial* next = nullptr;
+        for (Trial& trial : entry.trials) {
+            if (trial.issued >= kSamplesPerSize || (next && trial.issued >= next->issued)) continue;
+            next = &trial;
+        }
+        if (next) {
+            ++next->issued;
+            *sample = true;
+            return next->size;
+        }
+        // Every timing handed out: waiting for the results, unless the dropped trials
+        // were all that kept the remaining ones from deciding.
+        if (!pick_winner(kernel, bucket, entry)) return fallback;
+        winners = snapshot();
+    }
+    save(std::move(winners));
+    return fallback;
+}
+
+WorkgroupTuner::Trial* WorkgroupTuner::find_trial(uint64_t kernel, uint32_t bucket, uint32_t size) {
+    auto it = entries_.find({kernel, bucket});
+    if (it == entries_.end()) return nullptr;
+    for (Trial& trial : it->second.trials)
+        if (trial.size == size) return &trial;
+    return nullptr;
+}
+
+void WorkgroupTuner::record(uint64_t kernel, uint32_t bucket, uint32_t size, uint64_t ns) {
+    std::map<Key, uint32_t> winners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Trial* trial = find_trial(kernel, bucket, size);
+        if (!trial) return;
+        ++trial->done;
+        if (ns < trial->best_ns) trial->best_ns = ns;
+        if (!pick_winner(kernel, bucket, entries_[{kernel, bucket}])) return;
+        winners = snapshot();
+    }
+    // The file is written outside mutex_: this runs as frames retire, and other
+    // threads' launches keep choosing sizes meanwhile.
+    save(std::move(winners));
+}
+
+bool WorkgroupTuner::pick_winner(uint64_t kernel, uint32_t bucket, Entry& entry) {
+    if (entry.winner != 0 || entry.trials.empty()) return false;
+    const Trial* best = nullptr;
+    for (const Trial& t : entry.trials) {
+        if (t.done < kSamplesPerSize) return false;  // still tuning
+        if (!best || t.best_ns < best->best_ns) best = &t;
+    }
+    entry.winner = best->size;
+    if (std::getenv("PARALLAX_DEBUG"))
+        std::cerr << "[WorkgroupTuner] kernel " << std::hex << kernel << std::dec << " bucket " << bucket
+                  << ": workgroup size " << entry.winner << std::endl;
+    return true;
+}
+
+std::map<WorkgroupTuner::Key, uint32_t> WorkgroupTuner::snapshot() const {
+    std::map<Key, uint32_t> winners;
+    for (const auto& [key, entry] : entries_)
+        if (entry.winner != 0) winners[key] = entry.winner;
+    return winners;
+}
+
+void WorkgroupTuner::cancel(uint64_t kernel, uint32_t bucket, uint32_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Trial* trial = find_trial(kernel, bucket, size);
+    if (trial && trial->issued > trial->done) --trial->issued;
+}
+
+bool WorkgroupTuner::tuned(uint64_t kernel, uint32_t bucket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find({kernel, bucket});
+    return it != entries_.end() && it->second.winner != 0;
+}
+
+std::map<WorkgroupTuner::Key, uint32_t> WorkgroupTuner::read_cache() const {
+    std::map<Key, uint32_t> winners;
+    if (path_.empty()) return winners;
+    std::ifstream in(path_);
+    if (!in) return winners;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        uint64_t kernel = 0;
+        uint32_t bucket = 0, size = 0;
+        if (!(fields >> std::hex >> kernel >> std::dec >> bucket >> size) || size == 0) continue;
+        winners[{kernel, bucket}] = size;
+    }
+    return winners;
+}
+
+void WorkgroupTuner::load() {
+    for (const auto& [key, size] : read_cache()) {
+        Entry& entry = entries_[key];
+        if (entry.winner == 0) entry.winner = size;  // a winner found here takes precedence
+    }
+}
+
+void WorkgroupTuner::save(std::map<Key, uint32_t> winners) {
+    if (path_.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path_).parent_path(), ec);
+    // Other processes on the same device save to the same file: take its lock file for
+    // the read-merge-write, so no winner another process saved meanwhile is lost.
+    const int lock = ::open((path_ + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (lock >= 0) ::flock(lock, LOCK_EX);
+    const std::map<Key, uint32_t> saved = read_cache();
+    winners.insert(saved.begin(), saved.end());  // keeps ours where both have one
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        for (const auto& [key, size] : saved) {
+            Entry& entry = entries_[key];
+            if (entry.winner == 0) entry.winner = size;
+        }
+    }
+    // Write a sibling file private to this process and rename it over the cache, so a
+    // concurrent reader (another process starting on the same device) never sees a
+    // half-written file.
+    const std::string tmp = path_ + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[WorkgroupTuner] cannot write " << tmp << std::endl;
+            if (lock >= 0) ::close(lock);  // releases the flock
+            return;
+        }
+        out << "# parallax workgroup sizes: <kernel spirv hash> <size bucket> <workgroup size>\n";
+        for (const auto& [key, size] : winners)
+            out << std::hex << key.first << std::dec << ' ' << key.second << ' ' << size << '\n';
+    }
+    std::filesystem::rename(tmp, path_, ec);
+    if (ec) {
+        std::cerr << "[WorkgroupTuner] cannot update " << path_ << ": " << ec.message() << std::endl;
+        std::filesystem::remove(tmp, ec);
+    }
+    if (lock >= 0) ::close(lock);  // releases the flock
+}
+
+}  // namespace parallax
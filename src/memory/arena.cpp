@@ -276,6 +276,7 @@ bool UnifiedArena::initialize_from_pool(VulkanBackend* backend) {
 
 void UnifiedArena::copy_range(VkBuffer src, VkBuffer dst, VkDeviceSize size) {
     if (size == 0 || xfer_cmd_ == VK_NULL_HANDLE) return;
+    std::lock_guard<std::mutex> xfer_lock(xfer_mutex_);  // one transfer command buffer
     vkResetCommandBuffer(xfer_cmd_, 0);
     VkCommandBufferBeginInfo bi{};
     bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -285,12 +286,15 @@ void UnifiedArena::copy_range(VkBuffer src, VkBuffer dst, VkDeviceSize size) {
     vkCmdCopyBuffer(xfer_cmd_, src, dst, 1, &region);
     vkEndCommandBuffer(xfer_cmd_);
     vkResetFences(backend_->device(), 1, &xfer_fence_);
-    VkSubmitInfo si{};
-    si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    si.commandBufferCount = 1;
-    si.pCommandBuffers = &xfer_cmd_;
-    vkQueueSubmit(backend_->compute_queue(), 1, &si, xfer_fence_);
-    vkWaitForFences(backend_->device(), 1, &xfer_fence_, VK_TRUE, UINT64_MAX);
+    // Ordered after everything submitted to every compute queue (in-flight launches on
+    // any of them may write the arena); waited on below before anything else runs.
+    uint64_t value = 0;
+    if (backend_->submit(0, xfer_cmd_, xfer_fence_, &value, true) != VK_SUCCESS) {
+        std::cerr << "[UnifiedArena] migration copy submit failed" << std::endl;
+        return;
+    }
+    ++migrations_;
+    backend_->wait_fence(xfer_fence_);
 }
 
 void UnifiedArena::flush_to_device() {
@@ -4,8 +4,10 @@
 #include "parallax/vulkan_backend.hpp"
 #include "parallax/arena.hpp"
 #include "parallax/heap_pool.hpp"
+#include <atomic>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
 #include <iostream>
 
 namespace parallax {
@@ -14,13 +16,20 @@ namespace parallax {
 static std::unique_ptr<VulkanBackend> g_backend;
 static std::unique_ptr<MemoryManager> g_memory_manager;
 static std::unique_ptr<UnifiedArena> g_arena;
-static bool g_initialized = false;
+static std::atomic<bool> g_initialized{false};
+static std::atomic<UnifiedArena*> g_arena_ready{nullptr};  // published once fully built
 
+// First use may come from several host threads at once; the slow paths below run
+// under this lock. It is recursive because initialization re-enters on the same
+// thread (see g_initializing); the re-entry flags are only touched under it.
+static std::recursive_mutex g_init_mutex;
 static bool g_initializing = false;
 static bool g_arena_initializing = false;
 
 static bool ensure_initialized() {
-    if (g_initialized) return true;
+    if (g_initialized.load(std::memory_order_acquire)) return true;
+    std::lock_guard<std::recursive_mutex> lock(g_init_mutex);
+    if (g_initialized.load(std::memory_order_relaxed)) return true;
     // Vulkan initialization itself allocates; with allocation interposition active
     // those allocations re-enter here. Report "not ready" on re-entry so they fall
     // back to the system allocator instead of re-initializing (and corrupting) the
@@ -37,7 +46,7 @@ static bool ensure_initialized() {
     }
 
     g_memory_manager = std::make_unique<MemoryManager>(g_backend.get());
-    g_initialized = true;
+    g_initialized.store(true, std::memory_order_release);
     g_initializing = false;
     return true;
 }
@@ -53,6 +62,8 @@ MemoryManager* get_global_memory_manager() {
 }
 
 UnifiedArena* get_global_arena() {
+    if (UnifiedArena* ready = g_arena_ready.load(std::memory_order_acquire)) return ready;
+    std::lock_guard<std::recursive_mutex> lock(g_init_mutex);
     if (g_arena) return g_arena.get();
     // Creating the arena (buffer + bookkeeping) allocates; under interposition that
     // re-enters here. Report "not ready" on re-entry so those allocations fall back
@@ -73,6 +84,7 @@ UnifiedArena* get_global_arena() {
         return nullptr;
     }
     g_arena = std::move(arena);
+    g_arena_ready.store(g_arena.get(), std::memory_order_release);
     g_arena_initializing = false;
     return g_arena.get();
 }
@@ -93,6 +105,9 @@ void* parallax_arena_alloc(size_t size, size_t align) {
 }
 
 void parallax_arena_free(void* ptr) {
+    // A launch captured into a graph may bind this block; replaying it after the free
+    // would touch a dead range (the funnels' staging path frees right after its launch).
+    parallax::abort_graph_capture("arena memory freed during capture");
     auto* arena = parallax::get_global_arena();
     if (arena) arena->deallocate(ptr);
 }
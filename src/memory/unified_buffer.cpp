@@ -68,12 +68,14 @@ void* MemoryManager::allocate(size_t size) {
     buffer->init_dirty_tracking(); // Initialize block-level tracking
     
     void* ptr = buffer->host_ptr;
+    std::lock_guard<std::mutex> lock(mutex_);
     buffers_[ptr] = std::move(buffer);
     
     return ptr;
 }
 
 void MemoryManager::deallocate(void* ptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = buffers_.find(ptr);
     if (it == buffers_.end()) {
         std::cerr << "Attempt to free unknown pointer" << std::endl;
@@ -91,6 +93,7 @@ void MemoryManager::deallocate(void* ptr) {
 }
 
 void MemoryManager::sync(void* ptr, SyncDirection direction) {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = buffers_.find(ptr);
     if (it == buffers_.end()) {
         std::cerr << "Sync on unknown pointer" << std::endl;
@@ -112,6 +115,7 @@ void MemoryManager::sync(void* ptr, SyncDirection direction) {
 }
 
 void MemoryManager::sync_before_kernel(void* ptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = buffers_.find(ptr);
     if (it == buffers_.end()) {
         return;
@@ -124,6 +128,7 @@ void MemoryManager::sync_before_kernel(void* ptr) {
 }
 
 void MemoryManager::sync_after_kernel(void* ptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = buffers_.find(ptr);
     if (it == buffers_.end()) {
         return;
@@ -136,6 +141,7 @@ void MemoryManager::sync_after_kernel(void* ptr) {
 }
 
 VkBuffer MemoryManager::get_buffer(void* ptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = buffers_.find(ptr);
     if (it == buffers_.end()) {
         return VK_NULL_HANDLE;
@@ -269,7 +275,9 @@ bool MemoryManager::register_external_buffer(void* host_ptr, size_t size) {
         return false;
     }
     
-    // Check if already registered
+    // Check if already registered. The lock is held through the insert below so two
+    // threads registering the same pointer create only one buffer.
+    std::lock_guard<std::mutex> lock(mutex_);
     if (buffers_.find(host_ptr) != buffers_.end()) {
         std::cout << "[MemoryManager] Buffer already registered at " << host_ptr << std::endl;
         return true;
@@ -0,0 +1,74 @@
+// Descriptor-free launches: sum4_addressed.comp takes five arrays as device addresses
+// in its push block (no descriptor set at all), one more than the shared 3-binding
+// layout could bind. The launch goes through the C API and must be exact. Skips
+// cleanly without a device/arena or without buffer_device_address.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifndef SUM4_ADDRESSED_SPV
+#define SUM4_ADDRESSED_SPV "sum4_addressed.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+    if (!arena->capabilities().buffer_device_address || arena->device_address() == 0) {
+        std::printf("SKIP: device lacks buffer_device_address\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(SUM4_ADDRESSED_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", SUM4_ADDRESSED_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load sum4_addressed kernel\n"); return 1; }
+
+    // Not a multiple of any workgroup size, so the tail is guarded.
+    const size_t N = 10007;
+    void* arrays[5];
+    size_t elem_sizes[5];
+    for (int a = 0; a < 5; ++a) {
+        arrays[a] = arena->allocate(N * sizeof(float), 16);
+        if (!arrays[a]) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+        elem_sizes[a] = sizeof(float);
+    }
+    for (size_t i = 0; i < N; ++i) {
+        for (int a = 0; a < 4; ++a) static_cast<float*>(arrays[a])[i] = static_cast<float>((i + a) % 100);
+        static_cast<float*>(arrays[4])[i] = -1.0f;
+    }
+
+    parallax_kernel_launch_addressed(kernel, N, arrays, elem_sizes, 5);
+
+    const auto* out = static_cast<const float*>(arrays[4]);
+    for (size_t i = 0; i < N; ++i) {
+        float expected = 0.0f;
+        for (int a = 0; a < 4; ++a) expected += static_cast<float>((i + a) % 100);
+        if (out[i] != expected) {
+            std::fprintf(stderr, "FAIL: out[%zu] = %.1f, expected %.1f\n", i, out[i], expected);
+            return 1;
+        }
+    }
+    std::printf("PASS: five-array addressed launch over %zu elements is exact\n", N);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Async streams/events: issue reductions through parallax_reduce_async on a stream,
+// record an event, and check the scalar results land only through the event/stream
+// completion (and are exact). Reuses the reduce kernel. Skips cleanly without a
+// device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    // Two inputs with different exact sums (multi-level: 70000 > 256*256).
+    const uint32_t N = 70000;
+    auto* a = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    auto* b = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!a || !b) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    float want_a = 0.0f, want_b = 0.0f;
+    for (uint32_t i = 0; i < N; ++i) {
+        a[i] = static_cast<float>(i % 4);
+        b[i] = static_cast<float>(i % 2);
+        want_a += a[i];
+        want_b += b[i];
+    }
+
+    parallax_stream_t stream = parallax_stream_create();
+    parallax_event_t event = parallax_event_create();
+
+    float got_a = -1.0f, got_b = -1.0f;
+    parallax_reduce_async(stream, kernel, a, N, sizeof(float), &got_a);
+    parallax_event_record(event, stream);
+    parallax_event_wait(event);
+    if (!parallax_event_query(event)) { std::fprintf(stderr, "FAIL: event not complete after wait\n"); return 1; }
+    std::printf("async reduce a=%.1f expected=%.1f\n", got_a, want_a);
+    if (got_a != want_a) { std::fprintf(stderr, "FAIL: async reduce mismatch (a)\n"); return 1; }
+
+    // Back-to-back on the same stream: the second result must also land on synchronize.
+    parallax_reduce_async(stream, kernel, a, N, sizeof(float), &got_a);
+    parallax_reduce_async(stream, kernel, b, N, sizeof(float), &got_b);
+    parallax_stream_synchronize(stream);
+    std::printf("async reduce a=%.1f b=%.1f expected=%.1f/%.1f\n", got_a, got_b, want_a, want_b);
+    if (got_a != want_a || got_b != want_b) {
+        std::fprintf(stderr, "FAIL: async reduce mismatch after synchronize\n");
+        return 1;
+    }
+
+    parallax_event_destroy(event);
+    parallax_stream_destroy(stream);
+    std::printf("PASS: async stream/event reductions are exact\n");
+    return 0;
+}
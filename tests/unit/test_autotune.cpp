@@ -0,0 +1,88 @@
+// Workgroup-size autotuning: reduce.comp sizes its workgroup through a specialization
+// constant, so the runtime builds a variant per candidate size and times them on the
+// first launches of each problem size. Every one of those launches must still be exact
+// (the tuning runs on real work), and once a bucket is tuned its winner is written to
+// the per-device cache in PARALLAX_CACHE_DIR. Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    // A private cache directory, so an earlier run's winners cannot skip the tuning.
+    // Read when the launcher starts, so it must be set before the first launch.
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() /
+                                      ("parallax-autotune-" + std::to_string(getpid()));
+    std::filesystem::remove_all(dir);
+    setenv("PARALLAX_CACHE_DIR", dir.c_str(), 1);
+
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    // 5 candidate sizes x 3 samples each tune the first level; run well past that.
+    const uint32_t N = 100000;
+    auto* data = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!data) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    float expected = 0.0f;
+    for (uint32_t i = 0; i < N; ++i) {
+        data[i] = static_cast<float>(i % 8);
+        expected += data[i];
+    }
+    for (int run = 0; run < 40; ++run) {
+        float result = -1.0f;
+        parallax_reduce(kernel, data, N, sizeof(float), &result);
+        if (result != expected) {
+            std::fprintf(stderr, "FAIL: run %d reduced to %.1f, want %.1f\n", run, result, expected);
+            return 1;
+        }
+    }
+    parallax_stream_synchronize(nullptr);  // retire the last timed launches
+
+    const bool tuned = backend->capabilities().timestamp_valid_bits != 0 && !std::getenv("PARALLAX_NO_AUTOTUNE");
+    bool cached = false;
+    if (std::filesystem::exists(dir)) {
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+            cached |= entry.path().filename().string().rfind("workgroups-", 0) == 0;
+    }
+    std::filesystem::remove_all(dir);
+    if (tuned && !cached) {
+        std::fprintf(stderr, "FAIL: no workgroup cache written to %s\n", dir.c_str());
+        return 1;
+    }
+    std::printf("PASS: 40 reductions exact while tuning%s\n", tuned ? "; winners cached" : " (tuning off)");
+    return 0;
+}
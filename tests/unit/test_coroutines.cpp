@@ -0,0 +1,195 @@
+// Coroutine awaitables: several coroutines co_await reductions and sorts (explicit
+// kernels through parallax::async::run) and the stdpar-shaped factories (no compiler
+// plugin here, so those take the funnels' host fallback on the completion thread).
+// Results must be exact; a seq-policy await must complete on the awaiting thread
+// without suspending, awaits resumed through via() must come back on the main thread's
+// executor, and the default and inline_resume() ones must run off it. Skips cleanly
+// without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+#include "parallax/async.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+#ifndef BITONIC_SPV
+#define BITONIC_SPV "bitonic.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+
+std::atomic<int> failures{0};
+std::atomic<int> finished{0};
+
+// A coroutine nobody awaits: runs until its first co_await, frees itself at the end.
+struct detached {
+    struct promise_type {
+        detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { ++finished; }
+        void unhandled_exception() {
+            std::fprintf(stderr, "coroutine threw\n");
+            ++failures;
+            ++finished;
+        }
+    };
+};
+
+// The main thread's event loop: resumed coroutines queue here and run in main().
+struct main_loop {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> ready;
+
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(handle);
+        }
+        wake.notify_one();
+    }
+};
+
+main_loop loop;
+std::thread::id main_thread;
+
+parallax::async::executor on_main() {
+    return [](std::coroutine_handle<> handle) { loop.post(handle); };
+}
+
+void check(bool ok, int job, const char* what) {
+    if (ok) return;
+    std::fprintf(stderr, "job %d: %s\n", job, what);
+    ++failures;
+}
+
+detached job(int id, parallax_kernel_t reduce_k, parallax_kernel_t sort_k, float* data, uint32_t n,
+             float expected, float* keys, uint32_t sort_n) {
+    // A policy that does not offload: computed right here, on the main thread.
+    std::vector<float> small(100, 2.0f);
+    float host_sum =
+        co_await parallax::async::reduce(std::execution::seq, small.begin(), small.end(), 1.0f);
+    check(host_sum == 201.0f, id, "seq async::reduce mismatch");
+    check(std::this_thread::get_id() == main_thread, id, "seq async::reduce left the awaiting thread");
+
+    // Explicit kernel, resumed on the runtime's resumption pool.
+    float got = -1.0f;
+    co_await parallax::async::run([&](parallax_stream_t stream) {
+        parallax_reduce_async(stream, reduce_k, data, n, sizeof(float), &got);
+    });
+    check(got == expected, id, "pool-resumed reduction mismatch");
+    check(std::this_thread::get_id() != main_thread, id, "default resumption ran on the main thread");
+
+    // Explicit kernel, resumed inline on the completion thread.
+    got = -1.0f;
+    co_await parallax::async::run([&](parallax_stream_t stream) {
+        parallax_reduce_async(stream, reduce_k, data, n, sizeof(float), &got);
+    }).inline_resume();
+    check(got == expected, id, "inline-resumed reduction mismatch");
+    check(std::this_thread::get_id() != main_thread, id, "inline resumption ran on the main thread");
+
+    // Explicit kernel, resumed on the main thread.
+    for (uint32_t i = 0; i < sort_n; ++i)
+        keys[i] = static_cast<float>((i * 2654435761u + static_cast<uint32_t>(id)) % sort_n);
+    co_await parallax::async::run([&](parallax_stream_t stream) {
+        parallax_sort_async(stream, sort_k, keys, sort_n, sizeof(float));
+    }).via(on_main());
+    check(std::this_thread::get_id() == main_thread, id, "via() did not resume on the main thread");
+    for (uint32_t i = 0; i < sort_n; ++i) {
+        if (keys[i] != static_cast<float>(i)) {
+            check(false, id, "sort output out of order");
+            break;
+        }
+    }
+
+    // The stdpar-shaped factories.
+    std::vector<float> v(1000);
+    for (size_t i = 0; i < v.size(); ++i) v[i] = static_cast<float>(i % 10);
+    float sum = co_await parallax::async::reduce(parallax::par, v.begin(), v.end(), 0.5f).via(on_main());
+    check(sum == 4500.5f, id, "async::reduce mismatch");
+    check(std::this_thread::get_id() == main_thread, id, "async::reduce resumed off the main thread");
+
+    std::vector<float> kept(v.size());
+    auto end = co_await parallax::async::copy_if(parallax::par, v.begin(), v.end(), kept.begin(),
+                                                 [](float x) { return x > 6.0f; }).via(on_main());
+    check(end - kept.begin() == 300, id, "async::copy_if kept count");
+
+    co_await parallax::async::sort(parallax::par, v.begin(), v.end()).via(on_main());
+    check(v.front() == 0.0f && v.back() == 9.0f, id, "async::sort order");
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+    main_thread = std::this_thread::get_id();
+
+    std::vector<uint32_t> reduce_spv = read_spv(REDUCE_SPV);
+    std::vector<uint32_t> sort_spv = read_spv(BITONIC_SPV);
+    if (reduce_spv.empty() || sort_spv.empty()) { std::fprintf(stderr, "FAIL: read spv\n"); return 1; }
+    parallax_kernel_t reduce_k = parallax_kernel_load(reduce_spv.data(), reduce_spv.size());
+    parallax_kernel_t sort_k = parallax_kernel_load(sort_spv.data(), sort_spv.size());
+    if (!reduce_k || !sort_k) { std::fprintf(stderr, "FAIL: load kernels\n"); return 1; }
+
+    const int kJobs = 4;
+    const uint32_t kN = 1u << 16, kSortN = 1u << 14;
+    std::vector<float*> data(kJobs), keys(kJobs);
+    for (int j = 0; j < kJobs; ++j) {
+        data[j] = static_cast<float*>(arena->allocate(kN * sizeof(float), 16));
+        keys[j] = static_cast<float*>(arena->allocate(kSortN * sizeof(float), 16));
+        if (!data[j] || !keys[j]) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    }
+    // Sums below 2^24 in steps of whole numbers: exact in float.
+    for (int j = 0; j < kJobs; ++j) {
+        float expected = 0.0f;
+        for (uint32_t i = 0; i < kN; ++i) {
+            data[j][i] = static_cast<float>((i + static_cast<uint32_t>(j)) % 8);
+            expected += data[j][i];
+        }
+        job(j, reduce_k, sort_k, data[j], kN, expected, keys[j], kSortN);
+    }
+
+    // Run the main-thread side until every coroutine has finished.
+    while (finished < kJobs) {
+        std::unique_lock<std::mutex> lock(loop.mutex);
+        loop.wake.wait_for(lock, std::chrono::milliseconds(10), [] { return !loop.ready.empty(); });
+        while (!loop.ready.empty()) {
+            std::coroutine_handle<> handle = loop.ready.front();
+            loop.ready.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+        }
+    }
+    if (failures) { std::fprintf(stderr, "FAIL: %d checks failed\n", failures.load()); return 1; }
+    std::printf("PASS: %d coroutines awaited reductions, sorts and compactions\n", kJobs);
+    return 0;
+}
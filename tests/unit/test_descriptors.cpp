@@ -0,0 +1,79 @@
+// Descriptor paths: run more multi-level reductions than the old fixed descriptor pool
+// (1024 sets, never freed) could serve, and check every result stays exact. Without
+// arguments this uses push descriptors where the device has VK_KHR_push_descriptor;
+// with --pooled it forces the pooled-set fallback (per-frame pools reset on retire).
+// Reuses the reduce kernel. Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    // Must be set BEFORE the backend initializes (it does lazily at the first access).
+    const bool pooled = argc > 1 && std::strcmp(argv[1], "--pooled") == 0;
+    if (pooled) setenv("PARALLAX_NO_PUSH_DESCRIPTORS", "1", 1);
+
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+    std::printf("descriptor path: %s\n",
+                backend->capabilities().push_descriptor ? "push" : "pooled");
+    if (pooled && backend->capabilities().push_descriptor) {
+        std::fprintf(stderr, "FAIL: PARALLAX_NO_PUSH_DESCRIPTORS ignored\n");
+        return 1;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    // 70000 > 256*256: three levels, i.e. three descriptor bindings per reduction, so
+    // 500 reductions need ~1500 sets -- past the old pool's 1024.
+    const uint32_t N = 70000;
+    auto* data = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!data) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    float want = 0.0f;
+    for (uint32_t i = 0; i < N; ++i) {
+        data[i] = static_cast<float>(i % 4);
+        want += data[i];
+    }
+
+    for (int iter = 0; iter < 500; ++iter) {
+        float got = -1.0f;
+        parallax_reduce(kernel, data, N, sizeof(float), &got);
+        if (got != want) {
+            std::fprintf(stderr, "FAIL: reduction %d = %.1f, expected %.1f\n", iter, got, want);
+            return 1;
+        }
+    }
+
+    arena->deallocate(data);
+    std::printf("PASS: 500 reductions exact (%s descriptors)\n", pooled ? "pooled" : "default");
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Launch graphs: capture two reductions once, then replay them while the host changes
+// the input between replays; every replay must re-read the buffers and rewrite the
+// results (synchronously and on a stream). Capturing does not execute, and freeing
+// arena memory mid-capture aborts it. Reuses the reduce kernel. Skips cleanly without
+// a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    const uint32_t N = 70000;  // multi-level reductions
+    auto* a = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    auto* b = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!a || !b) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    float want_b = 0.0f;
+    for (uint32_t i = 0; i < N; ++i) {
+        a[i] = 0.0f;
+        b[i] = static_cast<float>(i % 2);
+        want_b += b[i];
+    }
+
+    float got_a = -1.0f, got_b = -1.0f;
+    parallax_graph_begin();
+    parallax_reduce(kernel, a, N, sizeof(float), &got_a);
+    parallax_reduce(kernel, b, N, sizeof(float), &got_b);
+    parallax_graph_t graph = parallax_graph_end();
+    if (!graph) { std::fprintf(stderr, "FAIL: capture produced no graph\n"); return 1; }
+    if (got_a != -1.0f || got_b != -1.0f) {
+        std::fprintf(stderr, "FAIL: captured launches executed during capture\n");
+        return 1;
+    }
+
+    parallax_stream_t stream = parallax_stream_create();
+    for (int iter = 1; iter <= 4; ++iter) {
+        float want_a = 0.0f;
+        for (uint32_t i = 0; i < N; ++i) {
+            a[i] = static_cast<float>((i + iter) % 4);
+            want_a += a[i];
+        }
+        got_a = got_b = -1.0f;
+        if (iter % 2) {
+            parallax_graph_launch(graph);
+        } else {
+            parallax_graph_launch_async(stream, graph);
+            parallax_stream_synchronize(stream);
+        }
+        std::printf("replay %d: a=%.1f b=%.1f expected=%.1f/%.1f\n", iter, got_a, got_b, want_a, want_b);
+        if (got_a != want_a || got_b != want_b) {
+            std::fprintf(stderr, "FAIL: replay %d mismatch\n", iter);
+            return 1;
+        }
+    }
+    parallax_stream_destroy(stream);
+    parallax_graph_destroy(graph);
+
+    // A freed arena block may be bound by a captured launch: the capture must abort.
+    void* tmp = parallax_arena_alloc(256, 16);
+    parallax_graph_begin();
+    parallax_reduce(kernel, a, N, sizeof(float), &got_a);
+    parallax_arena_free(tmp);
+    if (parallax_graph_end() != nullptr) {
+        std::fprintf(stderr, "FAIL: capture survived an arena free\n");
+        return 1;
+    }
+
+    arena->deallocate(a);
+    arena->deallocate(b);
+    std::printf("PASS: graph replays re-read inputs and rewrite results\n");
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Hazard tracking: launches recorded together (deferred under PARALLAX_LAZY, or captured
+// into a graph) are ordered only where they conflict. One sequence covers each kind:
+// a transform reads X, then X is rewritten in place (write-after-read), a second
+// transform reads the new X (read-after-write), two non-commuting maps rewrite the
+// first transform's output (write-after-write), and independent maps over other
+// buffers are interleaved throughout. A reduction of the second output ends the
+// recording. Every buffer must come out exact, which it cannot if a required barrier
+// is missing. Runs the sequence deferred, then as a graph. Skips cleanly without a
+// device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#ifndef FLAGS_SPV
+#define FLAGS_SPV "flags.spv"
+#endif
+#ifndef AXPB_SPV
+#define AXPB_SPV "axpb.spv"
+#endif
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+
+struct Captures {
+    float a;
+    float b;
+};
+}  // namespace
+
+int main() {
+    // Read once by the runtime, so it must be set before the first launch.
+    setenv("PARALLAX_LAZY", "1", 1);
+
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> flags_spv = read_spv(FLAGS_SPV);
+    std::vector<uint32_t> axpb_spv = read_spv(AXPB_SPV);
+    std::vector<uint32_t> reduce_spv = read_spv(REDUCE_SPV);
+    if (flags_spv.empty() || axpb_spv.empty() || reduce_spv.empty()) {
+        std::fprintf(stderr, "FAIL: read spv\n");
+        return 1;
+    }
+    parallax_kernel_t flags_k = parallax_kernel_load(flags_spv.data(), flags_spv.size());
+    parallax_kernel_t axpb_k = parallax_kernel_load(axpb_spv.data(), axpb_spv.size());
+    parallax_kernel_t reduce_k = parallax_kernel_load(reduce_spv.data(), reduce_spv.size());
+    if (!flags_k || !axpb_k || !reduce_k) { std::fprintf(stderr, "FAIL: load kernels\n"); return 1; }
+
+    const size_t N = 3000;
+    const int kIndependent = 8;
+    float* x = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    float* f = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    float* g = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    std::vector<float*> w(kIndependent);
+    for (float*& buffer : w) buffer = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!x || !f || !g) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    for (float* buffer : w)
+        if (!buffer) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+
+    // Every third element of X is set; flags.comp marks elements > 0.5.
+    auto reset = [&] {
+        for (size_t i = 0; i < N; ++i) {
+            x[i] = (i % 3 == 0) ? 1.0f : 0.0f;
+            f[i] = g[i] = -1.0f;
+            for (int k = 0; k < kIndependent; ++k) w[k][i] = static_cast<float>(i % 8);
+        }
+    };
+    auto axpb = [&](float* buffer, float a, float b) {
+        Captures c{a, b};
+        parallax_kernel_launch_with_captures(axpb_k, buffer, N, &c, sizeof(c), sizeof(float));
+    };
+    float sum = -1.0f;
+    auto sequence = [&] {
+        parallax_kernel_launch_transform2(flags_k, x, f, N, sizeof(float), sizeof(float));  // F = X
+        axpb(w[0], 1.0f, 0.0f);
+        axpb(x, -1.0f, 1.0f);  // X = 1 - X, after the transform read it
+        for (int k = 1; k < kIndependent / 2; ++k) axpb(w[k], 1.0f, static_cast<float>(k));
+        parallax_kernel_launch_transform2(flags_k, x, g, N, sizeof(float), sizeof(float));  // G = new X
+        axpb(f, 2.0f, 1.0f);  // F = 2F + 1, after the transform wrote it
+        for (int k = kIndependent / 2; k < kIndependent; ++k) axpb(w[k], 1.0f, static_cast<float>(k));
+        axpb(f, 1.0f, -3.0f);  // F = F - 3: does not commute with the step before
+        parallax_reduce(reduce_k, g, N, sizeof(float), &sum);
+    };
+    auto check = [&](const char* how) -> bool {
+        for (size_t i = 0; i < N; ++i) {
+            const float old_x = (i % 3 == 0) ? 1.0f : 0.0f;
+            const float want[3] = {1.0f - old_x, 2.0f * old_x - 2.0f, 1.0f - old_x};
+            const float got[3] = {x[i], f[i], g[i]};
+            for (int b = 0; b < 3; ++b) {
+                if (got[b] != want[b]) {
+                    std::fprintf(stderr, "%s: %c[%zu]=%.1f expected %.1f\n", how, "XFG"[b], i, got[b], want[b]);
+                    return false;
+                }
+            }
+            for (int k = 0; k < kIndependent; ++k) {
+                if (w[k][i] != static_cast<float>(i % 8 + k)) {
+                    std::fprintf(stderr, "%s: W%d[%zu]=%.1f expected %zu\n", how, k, i, w[k][i], i % 8 + k);
+                    return false;
+                }
+            }
+        }
+        const float want_sum = static_cast<float>(N - (N + 2) / 3);
+        if (sum != want_sum) {
+            std::fprintf(stderr, "%s: reduced G to %.1f, expected %.1f\n", how, sum, want_sum);
+            return false;
+        }
+        return true;
+    };
+
+    reset();
+    {
+        parallax::lazy_scope scope;
+        sequence();
+    }
+    if (!check("deferred")) { std::fprintf(stderr, "FAIL: deferred sequence\n"); return 1; }
+
+    reset();
+    parallax_graph_t graph = nullptr;
+    {
+        parallax::graph_capture capture;
+        sequence();
+        graph = capture.end();
+    }
+    if (!graph) { std::fprintf(stderr, "FAIL: graph capture\n"); return 1; }
+    parallax_graph_launch(graph);
+    const bool replayed = check("graph");
+    parallax_graph_destroy(graph);
+    if (!replayed) { std::fprintf(stderr, "FAIL: graph replay\n"); return 1; }
+
+    std::printf("PASS: %d launches ordered by their hazards, deferred and as a graph\n", 5 + kIndependent + 1);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Inline captures: axpb_inline.comp is loaded with PARALLAX_KERNEL_INLINE_CAPTURES and
+// reads its (a, b) closure from the push block, so each launch pushes its captures and
+// binds no uniform. Consecutive launches with different captures must each see their
+// own: they run deferred (PARALLAX_LAZY) into one submission, so only the pushes tell
+// them apart. Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#ifndef AXPB_INLINE_SPV
+#define AXPB_INLINE_SPV "axpb_inline.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+
+struct Captures {
+    float a;
+    float b;
+};
+}  // namespace
+
+int main() {
+    // Read on the first launch, so it must be set before it.
+    setenv("PARALLAX_LAZY", "1", 1);
+
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(AXPB_INLINE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", AXPB_INLINE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load_flags(spv.data(), spv.size(), PARALLAX_KERNEL_INLINE_CAPTURES);
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load axpb_inline kernel\n"); return 1; }
+
+    const size_t N = 4099;
+    auto* data = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!data) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    std::vector<float> expected(N);
+    for (size_t i = 0; i < N; ++i) data[i] = expected[i] = static_cast<float>(i % 16);
+
+    // Small integers throughout, so every step is exact in float.
+    const Captures steps[] = {{2.0f, 1.0f}, {1.0f, -3.0f}, {3.0f, 0.0f}};
+    for (const Captures& c : steps) {
+        Captures copy = c;
+        parallax_kernel_launch_with_captures(kernel, data, N, &copy, sizeof(copy), sizeof(float));
+        copy = {0.0f, 0.0f};  // the launch must not read the closure after it returns
+        for (float& e : expected) e = e * c.a + c.b;
+    }
+    parallax_flush();
+
+    for (size_t i = 0; i < N; ++i) {
+        if (data[i] != expected[i]) {
+            std::fprintf(stderr, "FAIL: data[%zu] = %.1f, expected %.1f\n", i, data[i], expected[i]);
+            return 1;
+        }
+    }
+    std::printf("PASS: three launches with inline captures are exact\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+// Dispatches past maxComputeWorkGroupCount[0]: a reduction whose first level needs
+// more workgroups than one grid row holds must run as a 2D grid (reduce.comp
+// linearizes its workgroup id) and still be exact. Tuning is turned off so the first
+// level runs at the kernel's own 256-wide workgroups. Skips cleanly without a
+// device/arena, or when the device's row is too long to exceed in a test.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    // Read when the launcher starts, so it must be set before the first launch.
+    setenv("PARALLAX_NO_AUTOTUNE", "1", 1);
+
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    // A little over one row of 256-wide workgroups.
+    const uint64_t max_x = backend->limits().maxComputeWorkGroupCount[0];
+    const uint64_t N = (max_x + 100) * 256;
+    if (N * sizeof(float) > arena->capacity() / 2) {
+        std::printf("SKIP: a %llu-workgroup row is too long to exceed here\n",
+                    static_cast<unsigned long long>(max_x));
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    auto* data = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!data) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    // One 1.0 every 64 elements: every partial, and the total (< 2^24), is exact.
+    float expected = 0.0f;
+    for (uint64_t i = 0; i < N; ++i) {
+        data[i] = (i % 64 == 0) ? 1.0f : 0.0f;
+        expected += data[i];
+    }
+
+    float result = -1.0f;
+    parallax_reduce(kernel, data, N, sizeof(float), &result);
+    std::printf("reduce of %llu elements (%llu workgroups) = %.1f, expected %.1f\n",
+                static_cast<unsigned long long>(N), static_cast<unsigned long long>(N / 256), result, expected);
+    if (result != expected) {
+        std::fprintf(stderr, "FAIL: 2D-grid reduction mismatch\n");
+        return 1;
+    }
+    std::printf("PASS: reduction past one grid row is exact\n");
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Batched launches: parallax_launch_batch records a set of capturing maps into one
+// submission. Eight independent maps over eight buffers carry no dependency and share
+// no barrier; a chain of three maps over one more buffer depends on its predecessor
+// each time (bit 0), and a last one on everything (PARALLAX_DEPENDS_ALL). Every buffer
+// must come out exact, which it cannot if a required barrier is missing (the chain's
+// steps do not commute). Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifndef AXPB_SPV
+#define AXPB_SPV "axpb.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+
+struct Captures {
+    float a;
+    float b;
+};
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(AXPB_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", AXPB_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load axpb kernel\n"); return 1; }
+
+    const size_t N = 2500;
+    const int kIndependent = 8;
+    std::vector<float*> buffers(kIndependent + 1);
+    std::vector<std::vector<float>> expected(kIndependent + 1);
+    for (size_t k = 0; k < buffers.size(); ++k) {
+        buffers[k] = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+        if (!buffers[k]) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+        expected[k].resize(N);
+        for (size_t i = 0; i < N; ++i) buffers[k][i] = expected[k][i] = static_cast<float>((i + k) % 8);
+    }
+
+    // Small integers throughout, so every step is exact in float.
+    std::vector<Captures> captures;
+    std::vector<parallax_launch_desc> descs;
+    std::vector<size_t> target;
+    auto add = [&](size_t k, Captures c, uint64_t depends_on) {
+        captures.push_back(c);
+        target.push_back(k);
+        parallax_launch_desc d{};
+        d.kernel = kernel;
+        d.in = buffers[k];
+        d.count = N;
+        d.in_elem_size = sizeof(float);
+        d.capture_size = sizeof(Captures);
+        d.depends_on = depends_on;
+        descs.push_back(d);
+    };
+    for (int k = 0; k < kIndependent; ++k) add(k, {1.0f, static_cast<float>(k)}, 0);
+    const size_t chain = kIndependent;
+    add(chain, {2.0f, 1.0f}, 0);
+    add(chain, {1.0f, -3.0f}, 1);  // after the step before
+    add(chain, {3.0f, 0.0f}, 1);
+    add(chain, {2.0f, -1.0f}, PARALLAX_DEPENDS_ALL);
+    for (size_t i = 0; i < descs.size(); ++i) descs[i].captures = &captures[i];  // stable now
+
+    parallax_launch_batch(descs.data(), descs.size());
+    for (size_t i = 0; i < descs.size(); ++i)
+        for (float& e : expected[target[i]]) e = e * captures[i].a + captures[i].b;
+
+    for (size_t k = 0; k < buffers.size(); ++k) {
+        for (size_t i = 0; i < N; ++i) {
+            if (buffers[k][i] != expected[k][i]) {
+                std::fprintf(stderr, "FAIL: buffer %zu [%zu] = %.1f, expected %.1f\n", k, i, buffers[k][i],
+                             expected[k][i]);
+                return 1;
+            }
+        }
+    }
+    std::printf("PASS: a %zu-launch batch with a dependency chain is exact\n", descs.size());
+    return 0;
+}
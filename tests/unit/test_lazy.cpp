@@ -0,0 +1,108 @@
+// Deferred execution (PARALLAX_LAZY=1): issue more scans than one batch holds, two of
+// them back to back on the same buffer, then parallax_flush() and check every buffer.
+// The chained pair needs the barrier between deferred launches (the second scan must
+// see the first one's output); the count forces a full batch to submit on its own.
+// Under PARALLAX_FORCE_STAGING=1 (the DeferredLaunchesStaging variant) it also checks
+// that each submitted batch migrates the arena once, not each launch in it.
+// Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#ifndef SCAN_SPV
+#define SCAN_SPV "scan.spv"
+#endif
+#ifndef SCAN_ADD_SPV
+#define SCAN_ADD_SPV "scan_add.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    // Read once by the runtime, so it must be set before the first launch.
+    setenv("PARALLAX_LAZY", "1", 1);
+
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) { std::printf("SKIP: no device/arena\n"); return 0; }
+    if (std::getenv("PARALLAX_FORCE_STAGING") && arena->uma()) {
+        std::fprintf(stderr, "FAIL: PARALLAX_FORCE_STAGING did not engage the staging path\n");
+        return 1;
+    }
+
+    std::vector<uint32_t> scan_spv = read_spv(SCAN_SPV);
+    std::vector<uint32_t> add_spv = read_spv(SCAN_ADD_SPV);
+    if (scan_spv.empty() || add_spv.empty()) { std::fprintf(stderr, "FAIL: read spv\n"); return 1; }
+
+    parallax_kernel_t scan_k = parallax_kernel_load(scan_spv.data(), scan_spv.size());
+    parallax_kernel_t add_k  = parallax_kernel_load(add_spv.data(), add_spv.size());
+    if (!scan_k || !add_k) { std::fprintf(stderr, "FAIL: load kernels\n"); return 1; }
+
+    // 80 buffers > one batch of deferred launches; N spans 4 scan blocks.
+    const uint32_t N = 1000;
+    const int kBuffers = 80;
+    std::vector<float*> bufs;
+    for (int b = 0; b < kBuffers; ++b) {
+        auto* data = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+        if (!data) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+        for (uint32_t i = 0; i < N; ++i) data[i] = 1.0f;
+        bufs.push_back(data);
+    }
+
+    const uint64_t migrations = arena->migrations();
+    {
+        parallax::lazy_scope scope;
+        parallax_scan(scan_k, add_k, bufs[0], N, sizeof(float));
+        parallax_scan(scan_k, add_k, bufs[0], N, sizeof(float));  // reads the first scan
+        for (int b = 1; b < kBuffers; ++b) parallax_scan(scan_k, add_k, bufs[b], N, sizeof(float));
+    }
+
+    // Scanning [1..N] again gives the triangular numbers (i+1)(i+2)/2, exact in float.
+    for (uint32_t i = 0; i < N; ++i) {
+        const float want = static_cast<float>((i + 1) * (i + 2) / 2);
+        if (bufs[0][i] != want) {
+            std::fprintf(stderr, "FAIL: chained scan[%u]=%.1f expected %.1f\n", i, bufs[0][i], want);
+            return 1;
+        }
+    }
+    for (int b = 1; b < kBuffers; ++b) {
+        for (uint32_t i = 0; i < N; ++i) {
+            if (bufs[b][i] != static_cast<float>(i + 1)) {
+                std::fprintf(stderr, "FAIL: buffer %d scan[%u]=%.1f expected %u\n",
+                             b, i, bufs[b][i], i + 1);
+                return 1;
+            }
+        }
+    }
+
+    if (!arena->uma()) {
+        // Two batches (one full, one flushed), each flushed in and invalidated out once.
+        const uint64_t copies = arena->migrations() - migrations;
+        std::printf("staging: %llu arena copies for %d deferred scans\n",
+                    static_cast<unsigned long long>(copies), kBuffers + 1);
+        if (copies > 4) {
+            std::fprintf(stderr, "FAIL: deferred launches migrated the arena per launch\n");
+            return 1;
+        }
+    }
+
+    for (float* data : bufs) arena->deallocate(data);
+    std::printf("PASS: %d deferred scans exact after flush\n", kBuffers + 1);
+    return 0;
+}
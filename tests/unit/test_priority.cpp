@@ -0,0 +1,110 @@
+// Launch priorities: a Low-priority thread sorts a large array (its bitonic schedule
+// split into bounded submissions) while the main thread, at High priority, runs small
+// reductions. Both must stay exact, and on a device with three compute queues or more
+// the High thread must sit on the queue kept for its class. Skips cleanly without a
+// device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+#ifndef BITONIC_SPV
+#define BITONIC_SPV "bitonic.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> reduce_spv = read_spv(REDUCE_SPV);
+    std::vector<uint32_t> sort_spv = read_spv(BITONIC_SPV);
+    if (reduce_spv.empty() || sort_spv.empty()) { std::fprintf(stderr, "FAIL: read spv\n"); return 1; }
+    parallax_kernel_t reduce_k = parallax_kernel_load(reduce_spv.data(), reduce_spv.size());
+    parallax_kernel_t sort_k = parallax_kernel_load(sort_spv.data(), sort_spv.size());
+    if (!reduce_k || !sort_k) { std::fprintf(stderr, "FAIL: load kernels\n"); return 1; }
+
+    // 2^20 keys: 210 stages of 2^20 elements, a few kSplitWork submissions.
+    const uint32_t kSortN = 1u << 20;
+    auto* keys = static_cast<float*>(arena->allocate(kSortN * sizeof(float), 16));
+    const uint32_t kSmallN = 4096;
+    auto* small = static_cast<float*>(arena->allocate(kSmallN * sizeof(float), 16));
+    if (!keys || !small) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    float small_sum = 0.0f;
+    for (uint32_t i = 0; i < kSmallN; ++i) {
+        small[i] = static_cast<float>(i % 8);
+        small_sum += small[i];
+    }
+
+    parallax_set_priority(PARALLAX_PRIORITY_HIGH);
+
+    std::atomic<int> failures{0};
+    std::atomic<bool> sorting{true};
+    std::thread batch([&] {
+        parallax_set_priority(PARALLAX_PRIORITY_LOW);
+        for (int round = 0; round < 2; ++round) {
+            // A scrambled permutation of 0..N-1 (exact in float below 2^24).
+            for (uint32_t i = 0; i < kSortN; ++i) keys[i] = static_cast<float>((i * 2654435761u) % kSortN);
+            parallax_sort(sort_k, keys, kSortN, sizeof(float));
+            for (uint32_t i = 0; i < kSortN; ++i) {
+                if (keys[i] != static_cast<float>(i)) {
+                    std::fprintf(stderr, "round %d: keys[%u]=%.1f after the sort\n", round, i, keys[i]);
+                    ++failures;
+                    break;
+                }
+            }
+        }
+        sorting = false;
+    });
+
+    int reductions = 0;
+    do {
+        float got = -1.0f;
+        parallax_reduce(reduce_k, small, kSmallN, sizeof(float), &got);
+        if (got != small_sum) {
+            std::fprintf(stderr, "reduction %d: got %.1f expected %.1f\n", reductions, got, small_sum);
+            ++failures;
+        }
+        ++reductions;
+    } while (sorting || reductions < 8);
+    batch.join();
+    if (failures) { std::fprintf(stderr, "FAIL: %d mismatches\n", failures.load()); return 1; }
+
+    const uint32_t queues = backend->compute_queue_count();
+    if (queues >= 3) {
+        bool high_used = false;
+        for (uint32_t q = 0; q < queues; ++q)
+            high_used |= backend->queue_role(q) == parallax::LaunchPriority::High && backend->queue_users(q) > 0;
+        if (!high_used) {
+            std::fprintf(stderr, "FAIL: no High-priority queue in use with %u queues\n", queues);
+            return 1;
+        }
+    }
+    std::printf("PASS: 2 split sorts at Low priority, %d reductions at High, %u compute queue(s)\n", reductions,
+                queues);
+    return 0;
+}
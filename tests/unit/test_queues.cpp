@@ -0,0 +1,114 @@
+// Multiple compute queues: two host threads each run a chain of async reductions at
+// the same time. Every launch context takes the compute queue with the fewest users,
+// so on a device with several queues the two threads' work lands on different queues
+// (and may overlap) while each thread's own submissions stay ordered. Every result must
+// be exact either way, and the queues must be given back once the threads exit. Skips
+// cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    const unsigned kThreads = 2;
+    const unsigned kLaunches = 16;
+    const uint32_t N = 1 << 18;
+    std::vector<float*> inputs(kThreads);
+    std::vector<float> want(kThreads, 0.0f);
+    for (unsigned t = 0; t < kThreads; ++t) {
+        inputs[t] = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+        if (!inputs[t]) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+        for (uint32_t i = 0; i < N; ++i) {
+            inputs[t][i] = static_cast<float>((i + 3 * t) % 4);
+            want[t] += inputs[t][i];
+        }
+    }
+
+    const uint32_t queues = backend->compute_queue_count();
+    auto total_users = [&] {
+        uint32_t users = 0;
+        for (uint32_t q = 0; q < queues; ++q) users += backend->queue_users(q);
+        return users;
+    };
+    const uint32_t users_before = total_users();
+
+    std::atomic<int> failures{0};
+    std::atomic<unsigned> done{0};
+    std::atomic<bool> leave{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&, t] {
+            // All launches in flight on the thread's queue, then one wait.
+            std::vector<float> got(kLaunches, -1.0f);
+            parallax_stream_t stream = parallax_stream_create();
+            for (unsigned i = 0; i < kLaunches; ++i)
+                parallax_reduce_async(stream, kernel, inputs[t], N, sizeof(float), &got[i]);
+            parallax_stream_synchronize(stream);
+            parallax_stream_destroy(stream);
+            for (unsigned i = 0; i < kLaunches; ++i) {
+                if (got[i] != want[t]) {
+                    std::fprintf(stderr, "thread %u launch %u: got %.1f expected %.1f\n", t, i, got[i], want[t]);
+                    ++failures;
+                }
+            }
+            // Stay alive (holding the queue) until the main thread has counted.
+            ++done;
+            while (!leave) std::this_thread::yield();
+        });
+    }
+    while (done < kThreads) std::this_thread::yield();
+    uint32_t used = 0;
+    for (uint32_t q = 0; q < queues; ++q) used += backend->queue_users(q) > 0;
+    leave = true;
+    for (auto& w : workers) w.join();
+    if (failures) { std::fprintf(stderr, "FAIL: %d reductions mismatched\n", failures.load()); return 1; }
+
+    const uint32_t want_used = queues < kThreads ? queues : kThreads;
+    if (used < want_used) {
+        std::fprintf(stderr, "FAIL: %u threads share %u of %u compute queues\n", kThreads, used, queues);
+        return 1;
+    }
+    // An exited thread's launch context is released with its queue.
+    if (total_users() != users_before) {
+        std::fprintf(stderr, "FAIL: %u queue users after the threads exited, %u before\n", total_users(),
+                     users_before);
+        return 1;
+    }
+    std::printf("PASS: %u threads x %u async reductions exact on %u of %u compute queue(s)\n", kThreads,
+                kLaunches, used, queues);
+    return 0;
+}
@@ -0,0 +1,79 @@
+// Concurrent launches: several host threads run reductions through the C ABI at the
+// same time (each on its own launch context) and every result must be exact. Reuses
+// the reduce kernel. Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    // One input per thread with a distinct exact sum (multi-level: 70000 > 256*256).
+    const unsigned kThreads = 4;
+    const unsigned kRounds = 8;
+    const uint32_t N = 70000;
+    std::vector<float*> inputs(kThreads);
+    std::vector<float> want(kThreads, 0.0f);
+    for (unsigned t = 0; t < kThreads; ++t) {
+        inputs[t] = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+        if (!inputs[t]) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+        for (uint32_t i = 0; i < N; ++i) {
+            inputs[t][i] = static_cast<float>((i + t) % 4);
+            want[t] += inputs[t][i];
+        }
+    }
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < kThreads; ++t) {
+        workers.emplace_back([&, t] {
+            for (unsigned r = 0; r < kRounds; ++r) {
+                float got = -1.0f;
+                parallax_reduce(kernel, inputs[t], N, sizeof(float), &got);
+                if (got != want[t]) {
+                    std::fprintf(stderr, "thread %u round %u: got %.1f expected %.1f\n", t, r, got, want[t]);
+                    ++failures;
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    if (failures) { std::fprintf(stderr, "FAIL: %d concurrent reductions mismatched\n", failures.load()); return 1; }
+    std::printf("PASS: %u threads x %u concurrent reductions are exact\n", kThreads, kRounds);
+    return 0;
+}
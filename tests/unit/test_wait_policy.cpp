@@ -0,0 +1,84 @@
+// Fence-wait policy: every synchronous launch ends in VulkanBackend::wait_fence, which
+// polls the fence before blocking in latency mode and blocks at once in efficiency
+// mode. Runs reductions of a few sizes under each mode (switched through the C API) and
+// checks they stay exact, that the mode took effect, and that the polling budget stays
+// within its bounds once waits have been observed. Skips cleanly without a device/arena.
+
+#include "parallax/runtime.hpp"
+#include "parallax/runtime.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifndef REDUCE_SPV
+#define REDUCE_SPV "reduce.spv"
+#endif
+
+namespace {
+std::vector<uint32_t> read_spv(const char* path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f) return {};
+    const auto size = static_cast<size_t>(f.tellg());
+    std::vector<uint32_t> data(size / 4);
+    f.seekg(0);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    return data;
+}
+}  // namespace
+
+int main() {
+    auto* backend = parallax::get_global_backend();
+    auto* arena = parallax::get_global_arena();
+    if (!backend || !arena || !arena->valid()) {
+        std::printf("SKIP: no Vulkan device / arena\n");
+        return 0;
+    }
+
+    std::vector<uint32_t> spv = read_spv(REDUCE_SPV);
+    if (spv.empty()) { std::fprintf(stderr, "FAIL: could not read %s\n", REDUCE_SPV); return 1; }
+    parallax_kernel_t kernel = parallax_kernel_load(spv.data(), spv.size());
+    if (!kernel) { std::fprintf(stderr, "FAIL: could not load reduce kernel\n"); return 1; }
+
+    const uint32_t N = 1 << 20;
+    auto* data = static_cast<float*>(arena->allocate(N * sizeof(float), 16));
+    if (!data) { std::fprintf(stderr, "FAIL: arena alloc\n"); return 1; }
+    for (uint32_t i = 0; i < N; ++i) data[i] = static_cast<float>(i % 4);
+
+    const struct { int mode; parallax::WaitMode want; const char* name; } modes[] = {
+        {PARALLAX_WAIT_LATENCY, parallax::WaitMode::Latency, "latency"},
+        {PARALLAX_WAIT_EFFICIENT, parallax::WaitMode::Efficiency, "efficiency"},
+    };
+    for (const auto& m : modes) {
+        parallax_set_wait_mode(m.mode);
+        if (backend->wait_mode() != m.want) {
+            std::fprintf(stderr, "FAIL: %s mode not applied\n", m.name);
+            return 1;
+        }
+        // Short and longer kernels, so the average the polling adapts to moves both ways.
+        for (uint32_t count : {256u, 65536u, N, 1000u}) {
+            float expected = 0.0f;
+            for (uint32_t i = 0; i < count; ++i) expected += data[i];
+            for (int run = 0; run < 5; ++run) {
+                float result = -1.0f;
+                parallax_reduce(kernel, data, count, sizeof(float), &result);
+                if (result != expected) {
+                    std::fprintf(stderr, "FAIL: %s mode: reduce of %u = %.1f, want %.1f\n", m.name, count,
+                                 result, expected);
+                    return 1;
+                }
+            }
+        }
+        const uint64_t budget = backend->spin_budget_ns();
+        if (budget < parallax::VulkanBackend::kMinSpinNs || budget > parallax::VulkanBackend::kMaxSpinNs) {
+            std::fprintf(stderr, "FAIL: polling budget %llu ns out of bounds\n",
+                         static_cast<unsigned long long>(budget));
+            return 1;
+        }
+        std::printf("%s mode: 20 reductions exact, next polling budget %llu ns\n", m.name,
+                    static_cast<unsigned long long>(budget));
+    }
+    std::printf("PASS: reductions exact under both wait modes\n");
+    return 0;
+}